@@ -4,7 +4,12 @@
 // Order of includes is very important here.
 #define TATAMI_R_PARALLELIZE_UNKNOWN
 #include "tatami_r/parallelize.hpp"
+#ifdef RTATAMI_USE_THREAD_POOL
+#include "Rtatami_pool.h"
+#define TATAMI_CUSTOM_PARALLEL Rtatami::pool_parallelize
+#else
 #define TATAMI_CUSTOM_PARALLEL tatami_r::parallelize
+#endif
 #include "tatami_r/tatami_r.hpp"
 
 #include "tatami/tatami.hpp"
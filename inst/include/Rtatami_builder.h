@@ -0,0 +1,432 @@
+#ifndef RTATAMI_BUILDER_H
+#define RTATAMI_BUILDER_H
+
+#include "Rtatami.h"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+
+namespace Rtatami {
+
+/**
+ * @brief Build a sparse matrix from multiple threads.
+ *
+ * Each thread should own a contiguous range of the primary dimension (i.e., columns for a compressed sparse column matrix),
+ * as is the case for the ranges supplied by `tatami::parallelize()`.
+ * The thread creates a `Workspace` for its range, adds the non-zero elements of each row/column in increasing order,
+ * and then calls `commit()` to hand over the workspace to the builder.
+ * Once all threads are finished, the main thread calls `to_R()` or `to_bound()` to assemble the final matrix.
+ *
+ * No locking is performed while adding elements, as each workspace is only ever modified by its own thread.
+ * During assembly, each workspace is copied directly into the output and then released,
+ * so the peak memory usage is limited to the output plus the workspaces that have not yet been copied.
+ * If the number of non-zero elements in each row/column can be cheaply computed in advance, consider using `TwoPassSparseBuilder` instead.
+ */
+class SparseBuilder {
+public:
+    /**
+     * @param nrow Number of rows in the matrix.
+     * @param ncol Number of columns in the matrix.
+     * @param row Whether the rows are the primary dimension, i.e., whether to build a compressed sparse row matrix.
+     */
+    SparseBuilder(int nrow, int ncol, bool row) : my_nrow(nrow), my_ncol(ncol), my_row(row) {}
+
+    /**
+     * @brief Thread-local buffer for the non-zero elements in a contiguous range of the primary dimension.
+     */
+    class Workspace {
+    public:
+        /**
+         * @cond
+         */
+        Workspace(int start, int length) : my_start(start), my_last(start), my_counts(length) {}
+        /**
+         * @endcond
+         */
+
+        /**
+         * Add the non-zero elements for a row/column of the primary dimension.
+         * This should be called with increasing `i` and at most once for each `i`;
+         * rows/columns that are not added are assumed to be empty.
+         *
+         * @param i Index of the row/column, which should lie in the range used to construct this workspace.
+         * @param n Number of non-zero elements.
+         * @param values Pointer to an array of length `n`, containing the values of the non-zero elements.
+         * @param indices Pointer to an array of length `n`, containing the sorted and unique indices of the non-zero elements on the secondary dimension.
+         */
+        void add(int i, int n, const double* values, const int* indices) {
+            if (i < my_last || i - my_start >= static_cast<int>(my_counts.size())) {
+                throw std::runtime_error("rows/columns should be added in increasing order within the workspace's range");
+            }
+            my_counts[i - my_start] = n;
+            my_values.insert(my_values.end(), values, values + n);
+            my_indices.insert(my_indices.end(), indices, indices + n);
+            my_last = i + 1;
+        }
+
+    private:
+        friend class SparseBuilder;
+        int my_start, my_last;
+        std::vector<std::size_t> my_counts;
+        std::vector<double> my_values;
+        std::vector<int> my_indices;
+
+        void release() {
+            std::vector<std::size_t>().swap(my_counts);
+            std::vector<double>().swap(my_values);
+            std::vector<int>().swap(my_indices);
+        }
+    };
+
+    /**
+     * Create a workspace for a contiguous range of the primary dimension.
+     * This can be safely called from any thread.
+     *
+     * @param start Index of the first row/column in the range.
+     * @param length Number of rows/columns in the range.
+     *
+     * @return An empty workspace.
+     */
+    Workspace workspace(int start, int length) const {
+        if (start < 0 || length < 0 || start + length > primary()) {
+            throw std::runtime_error("workspace range is out of bounds");
+        }
+        return Workspace(start, length);
+    }
+
+    /**
+     * Hand over a filled workspace to the builder.
+     * This can be safely called from any thread.
+     *
+     * @param work A workspace created by `workspace()`.
+     */
+    void commit(Workspace work) {
+        std::lock_guard<std::mutex> lck(my_lock);
+        my_workspaces.push_back(std::move(work));
+    }
+
+    /**
+     * Assemble a `dgCMatrix` (or `dgRMatrix`, if the rows are the primary dimension) from the committed workspaces.
+     * This should only be called from the main thread, as it allocates R objects.
+     * All workspaces are released after this function returns.
+     *
+     * @param threads Number of threads to use for copying workspaces into the output.
+     *
+     * @return The assembled sparse matrix.
+     */
+    Rcpp::RObject to_R(int threads = 1) {
+        auto pointers = compute_pointers();
+        std::size_t total = pointers.back();
+        if (total > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+            throw std::runtime_error("number of non-zero elements is too large for a dgCMatrix");
+        }
+
+        Rcpp::NumericVector x(total);
+        Rcpp::IntegerVector i(total);
+        copy_workspaces(pointers, static_cast<double*>(x.begin()), static_cast<int*>(i.begin()), threads);
+        Rcpp::IntegerVector p(pointers.begin(), pointers.end());
+
+        Rcpp::S4 output(my_row ? "dgRMatrix" : "dgCMatrix");
+        output.slot("x") = x;
+        output.slot(my_row ? "j" : "i") = i;
+        output.slot("p") = p;
+        output.slot("Dim") = Rcpp::IntegerVector::create(my_nrow, my_ncol);
+        return output;
+    }
+
+    /**
+     * Assemble a C++-owned compressed sparse matrix from the committed workspaces.
+     * All workspaces are released after this function returns.
+     *
+     * @param threads Number of threads to use for copying workspaces into the output.
+     *
+     * @return A `BoundNumericPointer` that can be returned to R, e.g., as if it were created by `beachmat::initializeCpp()`.
+     */
+    BoundNumericPointer to_bound(int threads = 1) {
+        auto p = compute_pointers();
+        std::size_t total = p.back();
+        std::vector<double> x(total);
+        std::vector<int> i(total);
+        copy_workspaces(p, x.data(), i.data(), threads);
+
+        auto output = new_BoundNumericMatrix();
+        output->ptr.reset(new tatami::CompressedSparseMatrix<double, int, std::vector<double>, std::vector<int>, std::vector<std::size_t> >(
+            my_nrow, my_ncol, std::move(x), std::move(i), std::move(p), my_row, /* check = */ false
+        ));
+        output->original = R_NilValue; // no R-owned data.
+        return output;
+    }
+
+private:
+    int my_nrow, my_ncol;
+    bool my_row;
+    std::mutex my_lock;
+    std::vector<Workspace> my_workspaces;
+
+    int primary() const {
+        return (my_row ? my_nrow : my_ncol);
+    }
+
+    std::vector<std::size_t> compute_pointers() {
+        std::sort(my_workspaces.begin(), my_workspaces.end(), [](const Workspace& left, const Workspace& right) -> bool { return left.my_start < right.my_start; });
+
+        int np = primary();
+        std::vector<std::size_t> counts(np);
+        int covered = 0;
+        for (const auto& work : my_workspaces) {
+            if (work.my_start < covered) {
+                throw std::runtime_error("workspaces should not have overlapping ranges");
+            }
+            std::copy(work.my_counts.begin(), work.my_counts.end(), counts.begin() + work.my_start);
+            covered = work.my_start + work.my_counts.size();
+        }
+
+        std::vector<std::size_t> p(np + 1);
+        for (int j = 0; j < np; ++j) {
+            p[j + 1] = p[j] + counts[j];
+        }
+        return p;
+    }
+
+    void copy_workspaces(const std::vector<std::size_t>& p, double* x, int* i, int threads) {
+        tatami::parallelize([&](int, std::size_t start, std::size_t length) -> void {
+            for (std::size_t w = start, end = start + length; w < end; ++w) {
+                auto& work = my_workspaces[w];
+                std::size_t offset = p[work.my_start];
+                std::copy(work.my_values.begin(), work.my_values.end(), x + offset);
+                std::copy(work.my_indices.begin(), work.my_indices.end(), i + offset);
+                work.release();
+            }
+        }, my_workspaces.size(), threads);
+        my_workspaces.clear();
+    }
+};
+
+/**
+ * @brief Build a sparse matrix from multiple threads in two passes.
+ *
+ * In the first pass, each thread calls `set_count()` with the number of non-zero elements for each row/column of the primary dimension that it owns.
+ * The main thread then calls `allocate()`, which computes the offsets and allocates the slots of the final matrix.
+ * In the second pass, each thread calls `fill()` (or writes to `values()` and `indices()` directly) for each row/column that it owns.
+ * Finally, the main thread calls `to_R()` or `to_bound()` to obtain the final matrix.
+ *
+ * Unlike `SparseBuilder`, the non-zero elements are written directly into their final locations without any thread-local buffers,
+ * so the peak memory usage is one copy of the output.
+ * This comes at the cost of computing the counts in the first pass, which is cheap for matrices where the number of structural non-zeros is known,
+ * e.g., by extracting sparse rows/columns with `tatami::Options::sparse_extract_value = false`.
+ *
+ * No locking is performed, as each row/column of the primary dimension should only be handled by a single thread.
+ */
+class TwoPassSparseBuilder {
+public:
+    /**
+     * This should be called from the main thread, as it allocates R objects.
+     *
+     * @param nrow Number of rows in the matrix.
+     * @param ncol Number of columns in the matrix.
+     * @param row Whether the rows are the primary dimension, i.e., whether to build a compressed sparse row matrix.
+     */
+    TwoPassSparseBuilder(int nrow, int ncol, bool row) : my_nrow(nrow), my_ncol(ncol), my_row(row), my_p(static_cast<std::size_t>(row ? nrow : ncol) + 1) {
+        my_pptr = static_cast<int*>(my_p.begin());
+    }
+
+    /**
+     * Set the number of non-zero elements for a row/column of the primary dimension.
+     * This can be safely called from any thread, provided that no other thread is setting the count for the same row/column.
+     * Rows/columns without a count are assumed to be empty.
+     *
+     * @param i Index of the row/column.
+     * @param n Number of non-zero elements.
+     */
+    void set_count(int i, int n) {
+        my_pptr[i + 1] = n;
+    }
+
+    /**
+     * Compute the offsets from the counts and allocate the final slots.
+     * This should only be called from the main thread after all counts have been set.
+     */
+    void allocate() {
+        int np = my_p.size() - 1;
+        std::size_t total = 0;
+        for (int j = 0; j < np; ++j) {
+            total += my_pptr[j + 1];
+            if (total > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+                throw std::runtime_error("number of non-zero elements is too large for a dgCMatrix");
+            }
+            my_pptr[j + 1] = total;
+        }
+
+        my_x = Rcpp::NumericVector(total);
+        my_xptr = static_cast<double*>(my_x.begin());
+        my_i = Rcpp::IntegerVector(total);
+        my_iptr = static_cast<int*>(my_i.begin());
+    }
+
+    /**
+     * @param i Index of the row/column.
+     * @return Number of non-zero elements in row/column `i`.
+     * This should only be called after `allocate()`.
+     */
+    int count(int i) const {
+        return my_pptr[i + 1] - my_pptr[i];
+    }
+
+    /**
+     * @param i Index of the row/column.
+     * @return Pointer to the values of the non-zero elements in row/column `i`, with space for `count(i)` elements.
+     * This should only be called after `allocate()`.
+     */
+    double* values(int i) {
+        return my_xptr + my_pptr[i];
+    }
+
+    /**
+     * @param i Index of the row/column.
+     * @return Pointer to the secondary indices of the non-zero elements in row/column `i`, with space for `count(i)` elements.
+     * This should only be called after `allocate()`.
+     */
+    int* indices(int i) {
+        return my_iptr + my_pptr[i];
+    }
+
+    /**
+     * Copy the non-zero elements for a row/column of the primary dimension into the final slots.
+     * This can be safely called from any thread after `allocate()`, provided that no other thread is filling the same row/column.
+     *
+     * @param i Index of the row/column.
+     * @param n Number of non-zero elements, which should be equal to the count for `i` in the first pass.
+     * @param values Pointer to an array of length `n`, containing the values of the non-zero elements.
+     * @param indices Pointer to an array of length `n`, containing the sorted and unique indices of the non-zero elements on the secondary dimension.
+     */
+    void fill(int i, int n, const double* values, const int* indices) {
+        if (n != count(i)) {
+            throw std::runtime_error("number of non-zero elements is not the same as that in the first pass");
+        }
+        std::copy_n(values, n, this->values(i));
+        std::copy_n(indices, n, this->indices(i));
+    }
+
+    /**
+     * Assemble a `dgCMatrix` (or `dgRMatrix`, if the rows are the primary dimension) from the filled slots.
+     * This should only be called from the main thread.
+     *
+     * @return The assembled sparse matrix.
+     */
+    Rcpp::RObject to_R() const {
+        Rcpp::S4 output(my_row ? "dgRMatrix" : "dgCMatrix");
+        output.slot("x") = my_x;
+        output.slot(my_row ? "j" : "i") = my_i;
+        output.slot("p") = my_p;
+        output.slot("Dim") = Rcpp::IntegerVector::create(my_nrow, my_ncol);
+        return output;
+    }
+
+    /**
+     * @return A `BoundNumericPointer` containing a view on the filled slots,
+     * which can be returned to R, e.g., as if it were created by `beachmat::initializeCpp()`.
+     */
+    BoundNumericPointer to_bound() const {
+        tatami::ArrayView<double> x_view(static_cast<const double*>(my_xptr), my_x.size());
+        tatami::ArrayView<int> i_view(static_cast<const int*>(my_iptr), my_i.size());
+        tatami::ArrayView<int> p_view(static_cast<const int*>(my_pptr), my_p.size());
+
+        auto output = new_BoundNumericMatrix();
+        output->ptr.reset(new tatami::CompressedSparseMatrix<double, int, decltype(x_view), decltype(i_view), decltype(p_view)>(
+            my_nrow, my_ncol, std::move(x_view), std::move(i_view), std::move(p_view), my_row, /* check = */ false
+        ));
+        output->original = Rcpp::List::create(my_x, my_i, my_p); // holding a reference to avoid GC.
+        return output;
+    }
+
+private:
+    int my_nrow, my_ncol;
+    bool my_row;
+
+    Rcpp::IntegerVector my_p;
+    int* my_pptr;
+    Rcpp::NumericVector my_x;
+    double* my_xptr = NULL;
+    Rcpp::IntegerVector my_i;
+    int* my_iptr = NULL;
+};
+
+/**
+ * @brief Build a dense matrix from multiple threads.
+ *
+ * The output is allocated as an R matrix upon construction, so this should be done on the main thread.
+ * Each thread can then write the rows or columns that it owns directly into the output, without any intermediate buffers or locking.
+ * Once all threads are finished, the main thread calls `to_R()` or `to_bound()` to obtain the final matrix.
+ */
+class DenseBuilder {
+public:
+    /**
+     * @param nrow Number of rows in the matrix.
+     * @param ncol Number of columns in the matrix.
+     */
+    DenseBuilder(int nrow, int ncol) : my_nrow(nrow), my_ncol(ncol), my_output(nrow, ncol) {}
+
+    /**
+     * Copy values into a column of the matrix.
+     * This can be safely called from any thread, provided that no other thread is writing to the same column.
+     *
+     * @param c Index of the column.
+     * @param values Pointer to an array of length equal to the number of rows.
+     */
+    void set_column(int c, const double* values) {
+        std::copy_n(values, my_nrow, column(c));
+    }
+
+    /**
+     * Copy values into a row of the matrix.
+     * This can be safely called from any thread, provided that no other thread is writing to the same row.
+     *
+     * @param r Index of the row.
+     * @param values Pointer to an array of length equal to the number of columns.
+     */
+    void set_row(int r, const double* values) {
+        double* out = static_cast<double*>(my_output.begin()) + r;
+        for (int c = 0; c < my_ncol; ++c, out += my_nrow) {
+            *out = values[c];
+        }
+    }
+
+    /**
+     * @param c Index of the column.
+     * @return Pointer to the start of column `c` in the output, which can be used to write values directly.
+     */
+    double* column(int c) {
+        return static_cast<double*>(my_output.begin()) + static_cast<std::size_t>(c) * static_cast<std::size_t>(my_nrow);
+    }
+
+    /**
+     * @return The assembled numeric matrix.
+     */
+    Rcpp::NumericMatrix to_R() const {
+        return my_output;
+    }
+
+    /**
+     * @return A `BoundNumericPointer` containing a view on the assembled matrix.
+     */
+    BoundNumericPointer to_bound() const {
+        auto output = new_BoundNumericMatrix();
+        tatami::ArrayView<double> view(static_cast<const double*>(my_output.begin()), my_output.size());
+        output->ptr.reset(new tatami::DenseMatrix<double, int, decltype(view)>(my_nrow, my_ncol, std::move(view), false));
+        output->original = my_output; // holding a reference to avoid GC.
+        return output;
+    }
+
+private:
+    int my_nrow, my_ncol;
+    Rcpp::NumericMatrix my_output;
+};
+
+}
+
+#endif
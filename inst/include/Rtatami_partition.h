@@ -0,0 +1,148 @@
+#ifndef RTATAMI_PARTITION_H
+#define RTATAMI_PARTITION_H
+
+#include "Rtatami.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace Rtatami {
+
+/**
+ * @cond
+ */
+namespace internal {
+
+template<class Cumulative_>
+std::vector<int> partition_by_cumulative(int n, int threads, Cumulative_ cumulative) {
+    int ntasks = std::max(1, std::min(threads, n));
+    std::vector<int> boundaries(ntasks + 1);
+    boundaries[ntasks] = n;
+
+    double total = cumulative(n);
+    int last = 0;
+    for (int t = 1; t < ntasks; ++t) {
+        double target = total * t / ntasks;
+
+        // Finding the first position where the cumulative weight reaches the target.
+        int left = last, right = n;
+        while (left < right) {
+            int mid = left + (right - left) / 2;
+            if (cumulative(mid) < target) {
+                left = mid + 1;
+            } else {
+                right = mid;
+            }
+        }
+
+        boundaries[t] = left;
+        last = left;
+    }
+
+    return boundaries;
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Partition the primary dimension of a compressed sparse matrix into contiguous ranges with roughly equal numbers of non-zero elements.
+ * Each row/column also contributes a weight of 1, to account for the per-row/column overhead of extraction.
+ *
+ * @tparam Pointer_ Integer type of the pointers.
+ *
+ * @param pointers Pointer to an array of length `n + 1`, containing the compressed pointers for the primary dimension.
+ * @param n Extent of the primary dimension.
+ * @param threads Number of threads.
+ *
+ * @return Vector of boundaries of length equal to the number of ranges plus 1.
+ * Range `t` starts at `boundaries[t]` and ends at `boundaries[t + 1]`.
+ * The number of ranges is equal to the smaller of `threads` and `n` (or 1, if both are zero).
+ */
+template<typename Pointer_>
+std::vector<int> partition_by_pointers(const Pointer_* pointers, int n, int threads) {
+    return internal::partition_by_cumulative(n, threads, [&](int j) -> double {
+        return static_cast<double>(pointers[j] - pointers[0]) + j;
+    });
+}
+
+/**
+ * Partition a dimension of a matrix into contiguous ranges with roughly equal numbers of non-zero elements.
+ * For sparse matrices, the number of non-zero elements is estimated by sampling evenly spaced rows/columns,
+ * where each unsampled row/column is assumed to have the same number as the closest preceding sample.
+ * Each row/column also contributes a weight of 1, to account for the per-row/column overhead of extraction.
+ *
+ * For dense matrices, or matrices that use an oracle along `row` (e.g., R-backed matrices, where sampling would involve expensive calls to the R interpreter),
+ * this just returns ranges of equal length.
+ *
+ * @param mat A **tatami** matrix.
+ * @param row Whether to partition the rows.
+ * @param threads Number of threads.
+ * @param samples_per_thread Number of rows/columns to sample for each thread.
+ *
+ * @return Vector of boundaries, see `partition_by_pointers()` for details.
+ */
+inline std::vector<int> partition_by_density(const tatami::NumericMatrix& mat, bool row, int threads, int samples_per_thread = 20) {
+    int n = (row ? mat.nrow() : mat.ncol());
+    if (threads <= 1 || n == 0 || !mat.is_sparse() || mat.uses_oracle(row)) {
+        return internal::partition_by_cumulative(n, threads, [](int j) -> double { return j; });
+    }
+
+    int nsamples = std::max(1, std::min(n, threads * samples_per_thread));
+    tatami::Options opt;
+    opt.sparse_extract_value = false;
+    opt.sparse_extract_index = false;
+    auto ext = tatami::new_extractor<true, false>(mat, row, false, opt);
+
+    std::vector<double> cumulative(n + 1);
+    int next = 0;
+    double current = 0;
+    for (int s = 0; s < nsamples; ++s) {
+        int pos = static_cast<int>(static_cast<double>(s) * n / nsamples);
+        for (; next < pos; ++next) {
+            cumulative[next + 1] = cumulative[next] + current;
+        }
+        auto range = ext->fetch(pos, NULL, NULL);
+        current = static_cast<double>(range.number) + 1;
+    }
+    for (; next < n; ++next) {
+        cumulative[next + 1] = cumulative[next] + current;
+    }
+
+    return internal::partition_by_cumulative(n, threads, [&](int j) -> double { return cumulative[j]; });
+}
+
+/**
+ * Run a function on each range of a partition in parallel, with one thread per range.
+ * This uses `tatami::parallelize()` and is thus safe to use with R-backed matrices.
+ *
+ * @tparam Function_ Function that accepts `(int t, int start, int length)`,
+ * where `t` is the index of the range and `start` and `length` define the range on the partitioned dimension.
+ *
+ * @param fun Function to run on each range.
+ * Ranges of zero length are skipped.
+ * @param boundaries Vector of boundaries, typically created by `partition_by_pointers()` or `partition_by_density()`.
+ */
+template<class Function_>
+void parallelize_partitions(Function_ fun, const std::vector<int>& boundaries) {
+    int ntasks = static_cast<int>(boundaries.size()) - 1;
+    if (ntasks <= 0) {
+        return;
+    }
+
+    tatami::parallelize([&](int, int start, int length) -> void {
+        for (int t = start, end = start + length; t < end; ++t) {
+            int len = boundaries[t + 1] - boundaries[t];
+            if (len > 0) {
+                fun(t, boundaries[t], len);
+            }
+        }
+    }, ntasks, ntasks);
+}
+
+}
+
+#endif
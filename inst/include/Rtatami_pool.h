@@ -0,0 +1,552 @@
+#ifndef RTATAMI_POOL_H
+#define RTATAMI_POOL_H
+
+#include "tatami_r/parallelize.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Rtatami {
+
+class DetachedExecutor;
+
+/**
+ * @cond
+ */
+namespace internal {
+
+// Set on threads where nested parallel calls should be executed serially.
+inline bool& serial_flag() {
+    thread_local bool flag = false;
+    return flag;
+}
+
+// Set on background threads that are not allowed to use the pool or the executor.
+inline bool& detached_flag() {
+    thread_local bool flag = false;
+    return flag;
+}
+
+// Set on background threads that have a dedicated queue for running R code.
+inline DetachedExecutor*& detached_executor_pointer() {
+    thread_local DetachedExecutor* ptr = NULL;
+    return ptr;
+}
+
+#ifdef _WIN32
+inline int current_pid() {
+    return _getpid();
+}
+#else
+inline pid_t current_pid() {
+    return getpid();
+}
+#endif
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Persistent pool of worker threads.
+ *
+ * Workers are created on demand and are kept alive between parallel sections,
+ * so that repeated calls to `tatami::parallelize()` do not pay the cost of creating new threads each time.
+ * After finishing a job, each worker spins for a configurable duration in case another job arrives quickly, before parking on a condition variable.
+ *
+ * There is one pool per shared library, as this header is compiled separately into each package that uses it.
+ * The pool should only be used from the main R thread.
+ *
+ * If the process is forked (e.g., by a BiocParallel MulticoreParam), the child does not inherit any of the worker threads
+ * and may inherit a copy of the lock in a locked state.
+ * Thus, the pool records the process ID that created its workers, and abandons its state in favor of a fresh one upon use in a different process.
+ */
+class ThreadPool {
+public:
+    /**
+     * @cond
+     */
+    ThreadPool() : my_state(new State) {}
+
+    ~ThreadPool() {
+        resize(0);
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    /**
+     * @endcond
+     */
+
+    /**
+     * @return Number of worker threads currently in the pool.
+     */
+    int size() {
+        check_fork();
+        return my_state->workers.size();
+    }
+
+    /**
+     * Change the number of worker threads in the pool.
+     * This should not be called inside a parallel section.
+     *
+     * @param n Number of worker threads.
+     */
+    void resize(int n) {
+        if (n < 0) {
+            throw std::runtime_error("number of threads in the pool should be non-negative");
+        }
+
+        check_fork();
+        auto& state = *my_state;
+        int current = state.workers.size();
+        if (n > current) {
+            // Passing the current generation so that new workers don't miss a job that is submitted before they start waiting.
+            std::size_t generation = state.generation.load(std::memory_order_acquire);
+            state.workers.reserve(n);
+            for (int w = current; w < n; ++w) {
+                state.workers.emplace_back(&ThreadPool::work, this, &state, w, generation);
+            }
+
+        } else if (n < current) {
+            {
+                std::lock_guard<std::mutex> lck(state.lock);
+                state.limit = n;
+                state.generation.fetch_add(1, std::memory_order_release);
+            }
+            state.cv.notify_all();
+            for (int w = n; w < current; ++w) {
+                state.workers[w].join();
+            }
+            state.workers.resize(n);
+            std::lock_guard<std::mutex> lck(state.lock);
+            state.limit = std::numeric_limits<int>::max();
+        }
+    }
+
+    /**
+     * @return Number of microseconds that idle workers will spin before parking.
+     */
+    int spin() const {
+        return my_spin.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @param microseconds Number of microseconds that idle workers should spin before parking.
+     * Larger values reduce the latency of successive jobs at the cost of CPU usage between jobs.
+     */
+    void set_spin(int microseconds) {
+        my_spin.store(std::max(0, microseconds), std::memory_order_relaxed);
+    }
+
+    /**
+     * Run tasks on the workers, growing the pool if there are fewer than `nthreads` workers.
+     * This function blocks until all tasks are complete.
+     * Meanwhile, the calling thread services any requests to run R code via the executor from `tatami_r::executor()`.
+     *
+     * @tparam Function_ Function that accepts `(int w, Index_ start, Index_ length)`, see `tatami::parallelize()`.
+     * @tparam Index_ Integer type of the number of tasks.
+     *
+     * @param fun Function to run on each worker.
+     * @param ntasks Number of tasks.
+     * @param nthreads Number of threads.
+     */
+    template<class Function_, typename Index_>
+    void run(Function_ fun, Index_ ntasks, int nthreads) {
+        Index_ per_worker = ntasks / nthreads + (ntasks % nthreads > 0);
+        int nworkers = ntasks / per_worker + (ntasks % per_worker > 0);
+        if (size() < nworkers) {
+            resize(nworkers);
+        }
+
+        auto& state = *my_state;
+        auto& mexec = tatami_r::executor();
+        mexec.initialize(nworkers, "failed to execute R command");
+        std::vector<std::string> errors(nworkers);
+
+        std::function<void(int)> job = [&](int w) -> void {
+            Index_ start = per_worker * w;
+            Index_ length = std::min(per_worker, static_cast<Index_>(ntasks - start));
+            try {
+                fun(w, start, length);
+            } catch (std::exception& x) {
+                errors[w] = x.what();
+            } catch (...) {
+                errors[w] = "unknown C++ exception";
+            }
+            mexec.finish_thread();
+        };
+
+        {
+            std::lock_guard<std::mutex> lck(state.lock);
+            state.job = &job;
+            state.num_jobs = nworkers;
+            state.generation.fetch_add(1, std::memory_order_release);
+        }
+        state.cv.notify_all();
+
+        mexec.listen();
+
+        // Waiting for all workers to acknowledge the job before 'job' goes out of scope.
+        {
+            std::unique_lock<std::mutex> lck(state.lock);
+            state.done_cv.wait(lck, [&]() -> bool { return state.finished == state.num_jobs; });
+            state.job = NULL;
+            state.num_jobs = 0;
+            state.finished = 0;
+        }
+
+        for (const auto& e : errors) {
+            if (!e.empty()) {
+                throw std::runtime_error(e);
+            }
+        }
+    }
+
+    /**
+     * @return Whether the current thread is a worker in this pool.
+     */
+    static bool in_worker() {
+        return internal::serial_flag();
+    }
+
+private:
+    struct State {
+        decltype(internal::current_pid()) pid = internal::current_pid();
+        std::vector<std::thread> workers;
+        std::atomic<std::size_t> generation = 0;
+
+        std::mutex lock;
+        std::condition_variable cv, done_cv;
+        int limit = std::numeric_limits<int>::max();
+        std::function<void(int)>* job = NULL;
+        int num_jobs = 0;
+        int finished = 0;
+    };
+
+    std::unique_ptr<State> my_state;
+    std::atomic<int> my_spin = 100;
+
+    void check_fork() {
+        if (my_state->pid != internal::current_pid()) {
+            // The threads in a forked child do not exist, so they cannot be joined, and destroying a joinable std::thread would terminate.
+            // The lock and condition variables might also be in an inconsistent state, so we just leak the entire state.
+            my_state.release();
+            my_state.reset(new State);
+        }
+    }
+
+    void work(State* state_ptr, int w, std::size_t seen) {
+        internal::serial_flag() = true;
+        auto& state = *state_ptr;
+
+        while (true) {
+            // Spinning for a little while in case another job arrives soon.
+            auto spin_until = std::chrono::steady_clock::now() + std::chrono::microseconds(my_spin.load(std::memory_order_relaxed));
+            while (state.generation.load(std::memory_order_acquire) == seen && std::chrono::steady_clock::now() < spin_until) {
+                std::this_thread::yield();
+            }
+
+            std::unique_lock<std::mutex> lck(state.lock);
+            state.cv.wait(lck, [&]() -> bool { return state.generation.load(std::memory_order_relaxed) != seen; });
+            seen = state.generation.load(std::memory_order_relaxed);
+            if (w >= state.limit) {
+                return;
+            }
+            if (state.job == NULL || w >= state.num_jobs) {
+                continue;
+            }
+
+            auto job = state.job;
+            lck.unlock();
+            (*job)(w);
+
+            lck.lock();
+            ++state.finished;
+            if (state.finished == state.num_jobs) {
+                state.done_cv.notify_all();
+            }
+        }
+    }
+};
+
+/**
+ * @return The thread pool for the current shared library.
+ */
+inline ThreadPool& thread_pool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+/**
+ * @brief Queue of requests to run R code from a detached background computation.
+ *
+ * The process-wide executor from `tatami_r::executor()` can only be serviced by the main thread within a parallel section,
+ * so it cannot be used by a computation that runs in the background while the main thread is free to do other work.
+ * Instead, each background computation can own an instance of this class, which its threads use to submit requests via `run()`.
+ * The main thread runs the pending requests whenever it checks in on the computation via `service()`.
+ */
+class DetachedExecutor {
+public:
+    /**
+     * Submit a function to be run on the main thread, and block until it is finished.
+     * This should be called from a thread of the background computation.
+     * Any exception thrown by `fun` is re-thrown as a `std::runtime_error` in the calling thread.
+     *
+     * @tparam Function_ Function that accepts no arguments.
+     * @param fun Function to run on the main thread.
+     */
+    template<class Function_>
+    void run(Function_ fun) {
+        Request req;
+        req.fun = [&]() -> void { fun(); };
+
+        std::unique_lock<std::mutex> lck(my_lock);
+        if (my_closed) {
+            throw std::runtime_error(my_message);
+        }
+        my_pending.push_back(&req);
+        my_cv.notify_all();
+        my_cv.wait(lck, [&]() -> bool { return req.done; });
+
+        if (!req.error.empty()) {
+            throw std::runtime_error(req.error);
+        }
+    }
+
+    /**
+     * Run all pending requests.
+     * This should only be called from the main thread.
+     *
+     * @return Whether any requests were run.
+     */
+    bool service() {
+        std::unique_lock<std::mutex> lck(my_lock);
+        bool any = false;
+        while (!my_pending.empty()) {
+            auto req = my_pending.front();
+            my_pending.pop_front();
+            lck.unlock();
+
+            try {
+                req->fun();
+            } catch (std::exception& e) {
+                req->error = e.what();
+                if (req->error.empty()) {
+                    req->error = "failed to execute R command";
+                }
+            } catch (...) {
+                req->error = "unknown C++ exception";
+            }
+
+            lck.lock();
+            req->done = true;
+            any = true;
+        }
+
+        if (any) {
+            my_cv.notify_all();
+        }
+        return any;
+    }
+
+    /**
+     * Block until there is a pending request, `pred` is true, or `timeout` has elapsed.
+     * This should only be called from the main thread.
+     * Any code that changes the result of `pred` should call `notify()` afterwards.
+     *
+     * @tparam Predicate_ Function that accepts no arguments and returns a boolean.
+     * @param timeout Maximum time to wait.
+     * @param pred Additional condition to stop waiting.
+     */
+    template<class Rep_, class Period_, class Predicate_>
+    void wait_for(const std::chrono::duration<Rep_, Period_>& timeout, Predicate_ pred) {
+        std::unique_lock<std::mutex> lck(my_lock);
+        my_cv.wait_for(lck, timeout, [&]() -> bool { return !my_pending.empty() || pred(); });
+    }
+
+    /**
+     * Wake up any caller of `wait_for()`.
+     */
+    void notify() {
+        {
+            std::lock_guard<std::mutex> lck(my_lock);
+        }
+        my_cv.notify_all();
+    }
+
+    /**
+     * Stop servicing requests.
+     * All pending and future calls to `run()` will throw an error with the supplied `message`.
+     * This is typically called when the background computation is being abandoned.
+     *
+     * @param message Error message.
+     */
+    void close(std::string message) {
+        std::lock_guard<std::mutex> lck(my_lock);
+        my_closed = true;
+        my_message = std::move(message);
+        for (auto req : my_pending) {
+            req->error = my_message;
+            req->done = true;
+        }
+        my_pending.clear();
+        my_cv.notify_all();
+    }
+
+private:
+    struct Request {
+        std::function<void()> fun;
+        bool done = false;
+        std::string error;
+    };
+
+    std::mutex my_lock;
+    std::condition_variable my_cv;
+    std::deque<Request*> my_pending;
+    bool my_closed = false;
+    std::string my_message;
+};
+
+/**
+ * @return Pointer to the `DetachedExecutor` for the current thread, or NULL if the current thread is not part of a detached computation with its own executor.
+ */
+inline DetachedExecutor* detached_executor() {
+    return internal::detached_executor_pointer();
+}
+
+/**
+ * @return Whether the current thread is part of a detached computation, see `DetachedScope`.
+ */
+inline bool is_detached() {
+    return internal::detached_flag();
+}
+
+/**
+ * @brief Mark the current thread as a detached background thread.
+ *
+ * While an instance of this class exists, calls to `pool_parallelize()` from the current thread will create new threads instead of using `thread_pool()`,
+ * and will not use the executor from `tatami_r::executor()`.
+ * This allows computations to run in the background while the main thread is free to use the pool and executor for other work.
+ *
+ * If a `DetachedExecutor` is supplied, it is made available to the current thread and any threads created by `detached_parallelize()` via `detached_executor()`.
+ * Code that needs to run R functions can then submit requests to it, to be run whenever the main thread calls `DetachedExecutor::service()`.
+ * Otherwise, the computation must not involve any R-backed matrices.
+ */
+class DetachedScope {
+public:
+    /**
+     * @cond
+     */
+    DetachedScope(DetachedExecutor* executor = NULL) {
+        internal::detached_flag() = true;
+        internal::detached_executor_pointer() = executor;
+    }
+
+    ~DetachedScope() {
+        internal::detached_flag() = false;
+        internal::detached_executor_pointer() = NULL;
+    }
+
+    DetachedScope(const DetachedScope&) = delete;
+    DetachedScope& operator=(const DetachedScope&) = delete;
+    /**
+     * @endcond
+     */
+};
+
+/**
+ * Run tasks on newly created threads, without using `thread_pool()` or the executor.
+ * This is used by `pool_parallelize()` inside a `DetachedScope`.
+ *
+ * @tparam Function_ Function that accepts `(int w, Index_ start, Index_ length)`, see `tatami::parallelize()`.
+ * @tparam Index_ Integer type of the number of tasks.
+ *
+ * @param fun Function to run on each worker.
+ * @param ntasks Number of tasks.
+ * @param nthreads Number of threads.
+ */
+template<class Function_, typename Index_>
+void detached_parallelize(Function_ fun, Index_ ntasks, int nthreads) {
+    Index_ per_worker = ntasks / nthreads + (ntasks % nthreads > 0);
+    int nworkers = ntasks / per_worker + (ntasks % per_worker > 0);
+    std::vector<std::string> errors(nworkers);
+    std::vector<std::thread> workers;
+    workers.reserve(nworkers);
+    auto executor = detached_executor();
+
+    for (int w = 0; w < nworkers; ++w) {
+        Index_ start = per_worker * w;
+        Index_ length = std::min(per_worker, static_cast<Index_>(ntasks - start));
+        workers.emplace_back([&](int w, Index_ start, Index_ length) -> void {
+            internal::serial_flag() = true;
+            DetachedScope scope(executor);
+            try {
+                fun(w, start, length);
+            } catch (std::exception& x) {
+                errors[w] = x.what();
+            } catch (...) {
+                errors[w] = "unknown C++ exception";
+            }
+        }, w, start, length);
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const auto& e : errors) {
+        if (!e.empty()) {
+            throw std::runtime_error(e);
+        }
+    }
+}
+
+/**
+ * Drop-in replacement for `tatami_r::parallelize()` that uses the persistent `thread_pool()`.
+ * This is used as the `TATAMI_CUSTOM_PARALLEL` if `RTATAMI_USE_THREAD_POOL` is defined before including `Rtatami.h`.
+ *
+ * Nested calls from within a worker are executed serially on that worker.
+ * Calls from within a `DetachedScope` are executed with `detached_parallelize()`.
+ *
+ * @tparam Function_ Function that accepts `(int w, Index_ start, Index_ length)`, see `tatami::parallelize()`.
+ * @tparam Index_ Integer type of the number of tasks.
+ *
+ * @param fun Function to run on each worker.
+ * @param ntasks Number of tasks.
+ * @param nthreads Number of threads.
+ */
+template<class Function_, typename Index_>
+void pool_parallelize(Function_ fun, Index_ ntasks, int nthreads) {
+    if (nthreads <= 1 || ntasks <= 1 || ThreadPool::in_worker()) {
+        fun(0, 0, ntasks);
+        return;
+    }
+    if (internal::detached_flag()) {
+        detached_parallelize(std::move(fun), ntasks, nthreads);
+        return;
+    }
+    thread_pool().run(std::move(fun), ntasks, nthreads);
+}
+
+}
+
+#endif
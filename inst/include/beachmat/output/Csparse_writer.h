@@ -6,10 +6,9 @@
 #include "../utils/utils.h"
 #include "../utils/dim_checker.h"
 
-#include <utility>
 #include <vector>
-#include <deque>
 #include <algorithm>
+#include <numeric>
 
 namespace beachmat { 
 
@@ -56,20 +55,25 @@ public:
 
     static std::string get_package() { return "Matrix"; }
 private:
-    typedef std::pair<size_t, T> data_pair;
-    std::vector<std::deque<data_pair> > data;
+    // Each column is stored as a pair of contiguous vectors of row indices
+    // and values, sorted by row index. This is cheaper to allocate than a
+    // container of pairs and allows the most common access pattern, i.e.,
+    // filling rows or columns in increasing order, to simply append.
+    struct column {
+        std::vector<int> index;
+        std::vector<T> value;
+    };
+    std::vector<column> data;
 
     // What is an empty value?
     static T get_empty();
 
-    // Only comparing the first value.
-    static bool only_first_less(const data_pair& lhs, const data_pair& rhs) { return lhs.first < rhs.first; }
-
-    template <class Iter>
-    static Iter find_matching_row(Iter, Iter, const data_pair&);
+    static size_t find_row(const column& current, size_t r) {
+        return std::lower_bound(current.index.begin(), current.index.end(), static_cast<int>(r)) - current.index.begin();
+    }
 
     // General column insertions.
-    static void insert_into_column(std::deque<data_pair>&, size_t, T);
+    static void insert_into_column(column&, size_t, T);
 };
 
 /*** Constructor definition ***/
@@ -83,66 +87,53 @@ template<typename T, class V>
 template<class Iter>
 void Csparse_writer<T, V>::set_col(size_t c, Iter in, size_t first, size_t last) {
     check_colargs(c, first, last);
-    std::deque<data_pair>& current=data[c];
-    std::deque<data_pair> new_set;
-
-    // Filling in all elements before start.
-    auto cIt=current.begin(); 
-    while (cIt!=current.end() && cIt->first < first) {
-        new_set.push_back(*cIt);
-        ++cIt;
+    column& current=data[c];
+    size_t lo=find_row(current, first);
+    size_t hi=find_row(current, last);
+
+    if (lo==current.index.size()) {
+        // Fast path for filling columns in increasing order of rows.
+        for (size_t index=first; index<last; ++index, ++in) {
+            if ((*in)!=get_empty()) { 
+                current.index.push_back(index);
+                current.value.push_back(*in);
+            }
+        }
+        return;
     }
-   
-    // Filling in all non-empty elements. 
+
+    // Otherwise, we replace all elements in [first, last) with the new non-empty elements.
+    std::vector<int> new_index;
+    std::vector<T> new_value;
     for (size_t index=first; index<last; ++index, ++in) {
         if ((*in)!=get_empty()) { 
-            new_set.push_back(data_pair(index, *in));
+            new_index.push_back(index);
+            new_value.push_back(*in);
         }
-    } 
-
-    // Jumping to the end.
-    while (cIt!=current.end() && cIt->first < last) {
-        ++cIt;
-    }
-
-    // Filling in remaining elements.
-    while (cIt!=current.end()) {
-        new_set.push_back(*cIt);
-        ++cIt;
     }
 
-    current.swap(new_set);
+    current.index.erase(current.index.begin() + lo, current.index.begin() + hi);
+    current.index.insert(current.index.begin() + lo, new_index.begin(), new_index.end());
+    current.value.erase(current.value.begin() + lo, current.value.begin() + hi);
+    current.value.insert(current.value.begin() + lo, new_value.begin(), new_value.end());
     return;
 }
 
 template<typename T, class V>
-template <class Iter>
-Iter Csparse_writer<T, V>::find_matching_row(Iter begin, Iter end, const data_pair& incoming) {
-    return std::lower_bound(begin, end, incoming, only_first_less);
-}
+void Csparse_writer<T, V>::insert_into_column(column& current, size_t r, T val) {
+    // Fast path for filling rows in increasing order.
+    if (current.index.empty() || static_cast<int>(r) > current.index.back()) {
+        current.index.push_back(r);
+        current.value.push_back(val);
+        return;
+    }
 
-template<typename T, class V>
-void Csparse_writer<T, V>::insert_into_column(std::deque<data_pair>& column, size_t r, T val) {
-    if (column.size()) {
-        if (r < column.front().first) {
-            column.push_front(data_pair(r, val));
-        } else if (r==column.front().first) {
-            column.front().second=val;
-        } else if (r > column.back().first) {
-            column.push_back(data_pair(r, val));
-        } else if (r==column.back().first) {
-            column.back().second=val;
-        } else {
-            data_pair incoming(r, val);
-            auto insert_loc=find_matching_row(column.begin(), column.end(), incoming);
-            if (insert_loc!=column.end() && insert_loc->first==r) { 
-                insert_loc->second=val;
-            } else {
-                column.insert(insert_loc, incoming);
-            }
-        }
+    size_t loc=find_row(current, r);
+    if (current.index[loc]==static_cast<int>(r)) { 
+        current.value[loc]=val;
     } else {
-        column.push_back(data_pair(r, val));
+        current.index.insert(current.index.begin() + loc, r);
+        current.value.insert(current.value.begin() + loc, val);
     }
     return;
 }
@@ -151,9 +142,12 @@ template<typename T, class V>
 template<class Iter>
 void Csparse_writer<T, V>::set_row(size_t r, Iter in, size_t first, size_t last) {
     check_rowargs(r, first, last);
-    for (size_t c=first; c<last; ++c, ++in) {
+
+    // Scattering each non-empty value into its column, which is an append if rows are filled in order.
+    auto dIt=data.begin() + first;
+    for (size_t c=first; c<last; ++c, ++in, ++dIt) {
         if ((*in)==get_empty()) { continue; }
-        insert_into_column(data[c], r, *in);
+        insert_into_column(*dIt, r, *in);
     }
     return;
 }
@@ -169,22 +163,33 @@ template<typename T, class V>
 template <class Iter>
 void Csparse_writer<T, V>::set_col_indexed(size_t c, size_t n, Rcpp::IntegerVector::iterator idx, Iter in) {
     check_colargs(c);
-    std::deque<data_pair>& current=data[c];
+    column& current=data[c];
+    size_t old_n=current.index.size();
     for (size_t i=0; i<n; ++i, ++idx, ++in) { 
-        current.push_back(data_pair(*idx, *in));
+        current.index.push_back(*idx);
+        current.value.push_back(*in);
     }
 
-    std::stable_sort(current.begin(), current.end(), only_first_less);
-    std::deque<data_pair> survivors;
-    auto cIt=current.begin();
-    while (cIt!=current.end()) { 
-        auto first=cIt->first; 
-        ++cIt;
-        while (cIt!=current.end() && cIt->first==first) { ++cIt; }
-        survivors.push_back(*(cIt-1));
+    // Sorting by row index; later entries take precedence over earlier entries for the same row. 
+    std::vector<size_t> order(current.index.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (!std::is_sorted(current.index.begin() + (old_n ? old_n - 1 : 0), current.index.end())) {
+        std::stable_sort(order.begin(), order.end(), [&](size_t left, size_t right) -> bool { return current.index[left] < current.index[right]; });
     }
 
-    current.swap(survivors);
+    column survivors;
+    survivors.index.reserve(order.size());
+    survivors.value.reserve(order.size());
+    for (size_t o=0; o<order.size(); ++o) {
+        auto i=order[o];
+        if (o + 1 < order.size() && current.index[order[o+1]]==current.index[i]) {
+            continue;
+        }
+        survivors.index.push_back(current.index[i]);
+        survivors.value.push_back(current.value[i]);
+    }
+
+    current=std::move(survivors);
     return;
 }
 
@@ -209,21 +214,13 @@ void Csparse_writer<T, V>::get_row(size_t r, Iter out, size_t first, size_t last
     std::fill(out, out+last-first, get_empty());
 
     for (size_t col=first; col<last; ++col, ++out) {
-        const std::deque<data_pair>& current=data[col];
-        if (current.empty() || r>current.back().first || r<current.front().first) {
+        const column& current=data[col];
+        if (current.index.empty() || static_cast<int>(r) > current.index.back() || static_cast<int>(r) < current.index.front()) {
             continue; 
         }
-        if (r==current.back().first) { 
-            (*out)=current.back().second;
-        } else if (r==current.front().first) {
-            (*out)=current.front().second;
-        } else {
-            // (*out) is equivalent to get_empty(), due to fill; not that it matters, 
-            // as find_matching_row() will only use the first value anyway.
-            auto loc=find_matching_row(current.begin(), current.end(), data_pair(r, *out)); 
-            if (loc!=current.end() && loc->first==r) { 
-                (*out)=loc->second;
-            }
+        size_t loc=find_row(current, r);
+        if (current.index[loc]==static_cast<int>(r)) { 
+            (*out)=current.value[loc];
         }
     }
     return;
@@ -233,18 +230,12 @@ template<typename T, class V>
 template<class Iter>
 void Csparse_writer<T, V>::get_col(size_t c, Iter out, size_t first, size_t last) {
     check_colargs(c, first, last);
-    const std::deque<data_pair>& current=data[c];
+    const column& current=data[c];
 
-    // Jumping forwards.
-    auto cIt=current.begin();
-    if (first) {
-        cIt=find_matching_row(current.begin(), current.end(), data_pair(first, get_empty()));
-    }
-    
     std::fill(out, out+last-first, get_empty());
-    while (cIt!=current.end() && cIt->first < last) { 
-        *(out + (cIt->first - first)) = cIt->second;
-        ++cIt;
+    size_t end=current.index.size();
+    for (size_t loc=(first ? find_row(current, first) : 0); loc<end && current.index[loc] < static_cast<int>(last); ++loc) {
+        *(out + (current.index[loc] - first)) = current.value[loc];
     }
     return;
 }
@@ -252,10 +243,10 @@ void Csparse_writer<T, V>::get_col(size_t c, Iter out, size_t first, size_t last
 template<typename T, class V>
 T Csparse_writer<T, V>::get(size_t r, size_t c) {
     check_oneargs(r, c);
-    const std::deque<data_pair>& current=data[c];
-    auto cIt=find_matching_row(current.begin(), current.end(), data_pair(r, get_empty()));
-    if (cIt!=current.end() && cIt->first==r) {
-        return cIt->second;
+    const column& current=data[c];
+    size_t loc=find_row(current, r);
+    if (loc!=current.index.size() && current.index[loc]==static_cast<int>(r)) {
+        return current.value[loc];
     } else {
         return get_empty();
     }
@@ -282,7 +273,7 @@ Rcpp::RObject Csparse_writer<T, V>::yield() {
     auto pIt=p.begin()+1;
     size_t total_size=0;
     for (auto dIt=data.begin(); dIt!=data.end(); ++dIt, ++pIt) { 
-        total_size+=dIt->size();
+        total_size+=dIt->index.size();
         (*pIt)=total_size;
     }
     mat.slot("p")=p;
@@ -299,11 +290,9 @@ Rcpp::RObject Csparse_writer<T, V>::yield() {
     auto xIt=x.begin();
     auto iIt=i.begin();
     for (size_t c=0; c<this->ncol; ++c) {
-        auto current=data[c];
-        for (auto cIt=current.begin(); cIt!=current.end(); ++cIt, ++xIt, ++iIt) {
-            (*iIt)=cIt->first;
-            (*xIt)=cIt->second;
-        }
+        const column& current=data[c];
+        iIt=std::copy(current.index.begin(), current.index.end(), iIt);
+        xIt=std::copy(current.value.begin(), current.value.end(), xIt);
     }
     mat.slot("i")=i;
     mat.slot("x")=x;
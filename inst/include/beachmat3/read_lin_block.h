@@ -12,6 +12,10 @@
 #include <stdexcept>
 #include <memory>
 
+#ifdef BEACHMAT_USE_TATAMI
+#include "tatami_reader.h"
+#endif
+
 namespace beachmat {
 
 /**
@@ -56,11 +60,23 @@ std::unique_ptr<M> read_lin_sparse_block_raw (Rcpp::RObject block) {
  * This can then be used to perform class- and type-agnostic extraction of row/column vectors.
  *
  * @param block An R object containing an ordinary submatrix, `dgCMatrix`, `lgCMatrix` or `SparseArraySeed`.
+ * If `BEACHMAT_USE_TATAMI` is defined, this may also be an external pointer produced by `beachmat::initializeCpp()`.
  *
  * @return A pointer to a `lin_matrix` instance.
  * This function will automatically choose the most appropriate subclass or throw an error if none are available.
  */
 inline std::unique_ptr<lin_matrix> read_lin_block(Rcpp::RObject block) {
+#ifdef BEACHMAT_USE_TATAMI
+    if (block.sexp_type() == EXTPTRSXP) {
+        Rtatami::BoundNumericPointer ptr(block);
+        if (ptr->ptr->is_sparse()) {
+            return std::unique_ptr<lin_matrix>(new lin_tatami_sparse_matrix(block));
+        } else {
+            return std::unique_ptr<lin_matrix>(new lin_tatami_matrix(block));
+        }
+    }
+#endif
+
     if (block.isS4()) {
         auto ptr = read_lin_sparse_block_raw<lin_matrix>(block);
         if (ptr) {
@@ -85,11 +101,18 @@ inline std::unique_ptr<lin_matrix> read_lin_block(Rcpp::RObject block) {
  * This can then be used to perform class- and type-agnostic extraction of row/column vectors and their non-zero values.
  *
  * @param block An R object containing a `dgCMatrix`, `lgCMatrix` or `SparseArraySeed`.
+ * If `BEACHMAT_USE_TATAMI` is defined, this may also be an external pointer produced by `beachmat::initializeCpp()` for a sparse matrix.
  *
  * @return A pointer to a `lin_sparse_matrix` instance.
  * This function will automatically choose the most appropriate subclass or throw an error if none are available.
  */
 inline std::unique_ptr<lin_sparse_matrix> read_lin_sparse_block(Rcpp::RObject block) {
+#ifdef BEACHMAT_USE_TATAMI
+    if (block.sexp_type() == EXTPTRSXP) {
+        return std::unique_ptr<lin_sparse_matrix>(new lin_tatami_sparse_matrix(block));
+    }
+#endif
+
     if (block.isS4()) {
         auto ptr = read_lin_sparse_block_raw<lin_sparse_matrix>(block);
         if (ptr) {
@@ -0,0 +1,361 @@
+#ifndef BEACHMAT_TATAMI_READER_H
+#define BEACHMAT_TATAMI_READER_H
+
+/**
+ * @file tatami_reader.h
+ *
+ * Internal utilities and class definitions for reading from a **tatami** matrix produced by `beachmat::initializeCpp()`.
+ * This requires the **assorthead** headers, so it is only included by `read_lin_block.h` if `BEACHMAT_USE_TATAMI` is defined.
+ */
+
+#include "Rcpp.h"
+#include "../Rtatami.h"
+
+#include "dim_checker.h"
+#include "lin_matrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace beachmat {
+
+/**
+ * @brief Reader for row/column data from a **tatami** matrix.
+ *
+ * Extractors are created on demand and reused for consecutive requests along the same dimension with the same `[first, last)` range,
+ * which is the typical access pattern when looping over all rows or columns.
+ *
+ * @note This is an internal class and should not be constructed directly by **beachmat** users.
+ */
+class tatami_reader : public dim_checker {
+public:
+    /**
+     * Constructor from an external pointer.
+     *
+     * @param input An external pointer produced by `beachmat::initializeCpp()`.
+     */
+    tatami_reader(Rcpp::RObject input) : original(input) {
+        Rtatami::BoundNumericPointer ptr(input);
+        mat = ptr->ptr;
+        this->nrow = mat->nrow();
+        this->ncol = mat->ncol();
+    }
+
+    ~tatami_reader() = default;
+    tatami_reader(tatami_reader&&) = default;
+    tatami_reader& operator=(tatami_reader&&) = default;
+
+    // Extractors cannot be copied, so the copy just recreates them on demand.
+    tatami_reader(const tatami_reader& other) : dim_checker(other), original(other.original), mat(other.mat) {}
+    tatami_reader& operator=(const tatami_reader& other) {
+        dim_checker::operator=(other);
+        original = other.original;
+        mat = other.mat;
+        dense_row.reset();
+        dense_col.reset();
+        sparse_row.reset();
+        sparse_col.reset();
+        return *this;
+    }
+
+    /**
+     * Extract values from a row or column of the matrix, possibly restricted to a contiguous subset.
+     *
+     * @param row Whether to extract a row.
+     * @param i The index of the row or column to extract.
+     * @param work A pointer to an array in which to store the extracted values, of length at least `last - first`.
+     * @param first Index of the first column (for rows) or row (for columns) of interest.
+     * @param last Index of one-past-the-last column or row of interest.
+     *
+     * @tparam T Type of the output values, either `int` or `double`.
+     *
+     * @return Pointer to the extracted values.
+     * For `double`, this may not be equal to `work` if the underlying matrix allows direct access to its values.
+     */
+    template<typename T>
+    const T* get(bool row, size_t i, T* work, size_t first, size_t last) {
+        if (row) {
+            this->check_rowargs(i, first, last);
+        } else {
+            this->check_colargs(i, first, last);
+        }
+
+        auto& ext = fetch_dense(row, first, last);
+        size_t n = last - first;
+        if constexpr(std::is_same<T, double>::value) {
+            return ext.fetch(i, work);
+        } else {
+            buffer_x.resize(n);
+            auto ptr = ext.fetch(i, buffer_x.data());
+            std::transform(ptr, ptr + n, work, to_output<T>);
+            return work;
+        }
+    }
+
+    /**
+     * Extract non-zero values from a row or column of the matrix, possibly restricted to a contiguous subset.
+     *
+     * @param row Whether to extract a row.
+     * @param i The index of the row or column to extract.
+     * @param work_x A pointer to an array in which to store the non-zero values, of length at least `last - first`.
+     * @param work_i A pointer to an array in which to store the indices, of length at least `last - first`.
+     * @param first Index of the first column (for rows) or row (for columns) of interest.
+     * @param last Index of one-past-the-last column or row of interest.
+     *
+     * @tparam T Type of the output values, either `int` or `double`.
+     *
+     * @return A `sparse_index` containing pointers to the non-zero values and their indices.
+     * These may not be equal to `work_x` and `work_i` if the underlying matrix allows direct access to its values.
+     */
+    template<typename T>
+    sparse_index<const T*, int> get_sparse(bool row, size_t i, T* work_x, int* work_i, size_t first, size_t last) {
+        if (row) {
+            this->check_rowargs(i, first, last);
+        } else {
+            this->check_colargs(i, first, last);
+        }
+
+        auto& ext = fetch_sparse(row, first, last);
+        if constexpr(std::is_same<T, double>::value) {
+            auto range = ext.fetch(i, work_x, work_i);
+            return sparse_index<const T*, int>(range.number, range.value, range.index);
+        } else {
+            buffer_x.resize(last - first);
+            auto range = ext.fetch(i, buffer_x.data(), work_i);
+            std::transform(range.value, range.value + range.number, work_x, to_output<T>);
+            return sparse_index<const T*, int>(range.number, work_x, range.index);
+        }
+    }
+
+    /**
+     * @return Whether the underlying matrix is sparse.
+     */
+    bool is_sparse() const {
+        return mat->is_sparse();
+    }
+
+    /**
+     * @return Number of structural non-zero elements in the underlying matrix.
+     * This is computed by iterating over the matrix, so it should not be called repeatedly.
+     */
+    size_t get_nnzero() const {
+        bool row = mat->prefer_rows();
+        tatami::Options opt;
+        opt.sparse_extract_value = false;
+        opt.sparse_extract_index = false;
+        auto ext = tatami::new_extractor<true, false>(*mat, row, false, opt);
+
+        size_t total = 0;
+        int primary = (row ? mat->nrow() : mat->ncol());
+        for (int p = 0; p < primary; ++p) {
+            total += ext->fetch(p, NULL, NULL).number;
+        }
+        return total;
+    }
+
+private:
+    Rcpp::RObject original; // holding onto the external pointer to protect any R-owned data.
+    std::shared_ptr<const tatami::NumericMatrix> mat;
+    std::vector<double> buffer_x;
+
+    template<typename T>
+    static T to_output(double x) {
+        // NAs are represented as NaNs in tatami, and casting these to integers is undefined.
+        if (std::isnan(x)) {
+            return NA_INTEGER;
+        }
+        return static_cast<T>(x);
+    }
+
+    template<class Extractor>
+    struct cached_extractor {
+        std::unique_ptr<Extractor> ext;
+        size_t first = 0, last = 0;
+
+        void reset() {
+            ext.reset();
+        }
+    };
+
+    cached_extractor<tatami::MyopicDenseExtractor<double, int> > dense_row, dense_col;
+    cached_extractor<tatami::MyopicSparseExtractor<double, int> > sparse_row, sparse_col;
+
+    tatami::MyopicDenseExtractor<double, int>& fetch_dense(bool row, size_t first, size_t last) {
+        auto& cache = (row ? dense_row : dense_col);
+        if (!cache.ext || cache.first != first || cache.last != last) {
+            cache.ext = tatami::new_extractor<false, false>(*mat, row, false, static_cast<int>(first), static_cast<int>(last - first), tatami::Options());
+            cache.first = first;
+            cache.last = last;
+        }
+        return *(cache.ext);
+    }
+
+    tatami::MyopicSparseExtractor<double, int>& fetch_sparse(bool row, size_t first, size_t last) {
+        auto& cache = (row ? sparse_row : sparse_col);
+        if (!cache.ext || cache.first != first || cache.last != last) {
+            cache.ext = tatami::new_extractor<true, false>(*mat, row, false, static_cast<int>(first), static_cast<int>(last - first), tatami::Options());
+            cache.first = first;
+            cache.last = last;
+        }
+        return *(cache.ext);
+    }
+};
+
+/**
+ * @brief Logical, integer or numeric matrices represented by a **tatami** matrix, e.g., from `beachmat::initializeCpp()`.
+ *
+ * This allows code written against the `lin_matrix` interface to read from any matrix supported by `initializeCpp()`,
+ * including delayed operations and file-backed matrices, without realizing blocks in R.
+ * It is unlikely that this class will be constructed directly by users;
+ * most applications will use `read_lin_block()` instead.
+ */
+class lin_tatami_matrix : public lin_matrix {
+public:
+    /**
+     * Constructor from an external pointer.
+     *
+     * @param mat An external pointer produced by `beachmat::initializeCpp()`.
+     */
+    lin_tatami_matrix(Rcpp::RObject mat) : reader(mat) {
+        this->nrow = reader.get_nrow();
+        this->ncol = reader.get_ncol();
+        return;
+    }
+
+    ~lin_tatami_matrix() = default;
+    lin_tatami_matrix(const lin_tatami_matrix&) = default;
+    lin_tatami_matrix& operator=(const lin_tatami_matrix&) = default;
+    lin_tatami_matrix(lin_tatami_matrix&&) = default;
+    lin_tatami_matrix& operator=(lin_tatami_matrix&&) = default;
+
+    const int* get_col(size_t c, int* work, size_t first, size_t last) {
+        return reader.get(false, c, work, first, last);
+    }
+
+    const int* get_row(size_t r, int* work, size_t first, size_t last) {
+        return reader.get(true, r, work, first, last);
+    }
+
+    const double* get_col(size_t c, double* work, size_t first, size_t last) {
+        return reader.get(false, c, work, first, last);
+    }
+
+    const double* get_row(size_t r, double* work, size_t first, size_t last) {
+        // Rows are always copied into the workspace, as promised by the lin_matrix interface.
+        auto out = reader.get(true, r, work, first, last);
+        if (out != work) {
+            std::copy(out, out + last - first, work);
+        }
+        return work;
+    }
+
+private:
+    tatami_reader reader;
+
+    lin_tatami_matrix* clone_internal() const {
+        return new lin_tatami_matrix(*this);
+    }
+};
+
+/**
+ * @brief Sparse logical, integer or numeric matrices represented by a **tatami** matrix, e.g., from `beachmat::initializeCpp()`.
+ *
+ * It is unlikely that this class will be constructed directly by users;
+ * most applications will use `read_lin_block()` or `read_lin_sparse_block()` instead.
+ */
+class lin_tatami_sparse_matrix : public lin_sparse_matrix {
+public:
+    /**
+     * Constructor from an external pointer.
+     *
+     * @param mat An external pointer produced by `beachmat::initializeCpp()`, referring to a sparse matrix.
+     */
+    lin_tatami_sparse_matrix(Rcpp::RObject mat) : reader(mat) {
+        if (!reader.is_sparse()) {
+            throw std::runtime_error("tatami matrix is not sparse");
+        }
+        this->nrow = reader.get_nrow();
+        this->ncol = reader.get_ncol();
+        return;
+    }
+
+    ~lin_tatami_sparse_matrix() = default;
+    lin_tatami_sparse_matrix(const lin_tatami_sparse_matrix&) = default;
+    lin_tatami_sparse_matrix& operator=(const lin_tatami_sparse_matrix&) = default;
+    lin_tatami_sparse_matrix(lin_tatami_sparse_matrix&&) = default;
+    lin_tatami_sparse_matrix& operator=(lin_tatami_sparse_matrix&&) = default;
+
+    const int* get_col(size_t c, int* work, size_t first, size_t last) {
+        return reader.get(false, c, work, first, last);
+    }
+
+    const int* get_row(size_t r, int* work, size_t first, size_t last) {
+        return reader.get(true, r, work, first, last);
+    }
+
+    const double* get_col(size_t c, double* work, size_t first, size_t last) {
+        return reader.get(false, c, work, first, last);
+    }
+
+    const double* get_row(size_t r, double* work, size_t first, size_t last) {
+        auto out = reader.get(true, r, work, first, last);
+        if (out != work) {
+            std::copy(out, out + last - first, work);
+        }
+        return work;
+    }
+
+    sparse_index<const int*, int> get_col(size_t c, int* work_x, int* work_i, size_t first, size_t last) {
+        return reader.get_sparse(false, c, work_x, work_i, first, last);
+    }
+
+    sparse_index<const int*, int> get_row(size_t r, int* work_x, int* work_i, size_t first, size_t last) {
+        return copy_to_workspace(reader.get_sparse(true, r, work_x, work_i, first, last), work_x, work_i);
+    }
+
+    sparse_index<const double*, int> get_col(size_t c, double* work_x, int* work_i, size_t first, size_t last) {
+        return reader.get_sparse(false, c, work_x, work_i, first, last);
+    }
+
+    sparse_index<const double*, int> get_row(size_t r, double* work_x, int* work_i, size_t first, size_t last) {
+        return copy_to_workspace(reader.get_sparse(true, r, work_x, work_i, first, last), work_x, work_i);
+    }
+
+    size_t get_nnzero () const {
+        // Computed lazily as this requires a pass over the matrix.
+        if (!nnzero_cached) {
+            nnzero = reader.get_nnzero();
+            nnzero_cached = true;
+        }
+        return nnzero;
+    }
+
+private:
+    tatami_reader reader;
+    mutable size_t nnzero = 0;
+    mutable bool nnzero_cached = false;
+
+    template<typename T>
+    static sparse_index<const T*, int> copy_to_workspace(sparse_index<const T*, int> ref, T* work_x, int* work_i) {
+        // Rows are always copied into the workspaces, as promised by the lin_sparse_matrix interface.
+        if (ref.x != work_x) {
+            std::copy(ref.x, ref.x + ref.n, work_x);
+        }
+        if (ref.i != work_i) {
+            std::copy(ref.i, ref.i + ref.n, work_i);
+        }
+        return sparse_index<const T*, int>(ref.n, work_x, work_i);
+    }
+
+    lin_tatami_sparse_matrix* clone_internal() const {
+        return new lin_tatami_sparse_matrix(*this);
+    }
+};
+
+}
+
+#endif
@@ -10,6 +10,78 @@ Rcpp::Rostream<true>&  Rcpp::Rcout = Rcpp::Rcpp_cout_get();
 Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
+// tatami_async_poll
+Rcpp::LogicalVector tatami_async_poll(SEXP raw_job);
+RcppExport SEXP _beachmat_tatami_async_poll(SEXP raw_jobSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_job(raw_jobSEXP);
+    rcpp_result_gen = Rcpp::wrap(tatami_async_poll(raw_job));
+    return rcpp_result_gen;
+END_RCPP
+}
+// tatami_async_deferred
+Rcpp::LogicalVector tatami_async_deferred(SEXP raw_job);
+RcppExport SEXP _beachmat_tatami_async_deferred(SEXP raw_jobSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_job(raw_jobSEXP);
+    rcpp_result_gen = Rcpp::wrap(tatami_async_deferred(raw_job));
+    return rcpp_result_gen;
+END_RCPP
+}
+// tatami_async_wait
+Rcpp::LogicalVector tatami_async_wait(SEXP raw_job, double timeout);
+RcppExport SEXP _beachmat_tatami_async_wait(SEXP raw_jobSEXP, SEXP timeoutSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_job(raw_jobSEXP);
+    Rcpp::traits::input_parameter< double >::type timeout(timeoutSEXP);
+    rcpp_result_gen = Rcpp::wrap(tatami_async_wait(raw_job, timeout));
+    return rcpp_result_gen;
+END_RCPP
+}
+// tatami_async_result
+SEXP tatami_async_result(SEXP raw_job);
+RcppExport SEXP _beachmat_tatami_async_result(SEXP raw_jobSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_job(raw_jobSEXP);
+    rcpp_result_gen = Rcpp::wrap(tatami_async_result(raw_job));
+    return rcpp_result_gen;
+END_RCPP
+}
+// tatami_async_cancel
+SEXP tatami_async_cancel(SEXP raw_job);
+RcppExport SEXP _beachmat_tatami_async_cancel(SEXP raw_jobSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_job(raw_jobSEXP);
+    rcpp_result_gen = Rcpp::wrap(tatami_async_cancel(raw_job));
+    return rcpp_result_gen;
+END_RCPP
+}
+// apply_delayed_callback
+SEXP apply_delayed_callback(SEXP raw_input, Rcpp::RObject op);
+RcppExport SEXP _beachmat_apply_delayed_callback(SEXP raw_inputSEXP, SEXP opSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type op(opSEXP);
+    rcpp_result_gen = Rcpp::wrap(apply_delayed_callback(raw_input, op));
+    return rcpp_result_gen;
+END_RCPP
+}
+// set_executor_coalescing
+Rcpp::LogicalVector set_executor_coalescing(bool enabled);
+RcppExport SEXP _beachmat_set_executor_coalescing(SEXP enabledSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< bool >::type enabled(enabledSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_executor_coalescing(enabled));
+    return rcpp_result_gen;
+END_RCPP
+}
 // initialize_constant_matrix
 SEXP initialize_constant_matrix(int nrow, int ncol, double val);
 RcppExport SEXP _beachmat_initialize_constant_matrix(SEXP nrowSEXP, SEXP ncolSEXP, SEXP valSEXP) {
@@ -57,12 +129,48 @@ BEGIN_RCPP
 END_RCPP
 }
 // apply_delayed_round
-SEXP apply_delayed_round(SEXP raw_input);
-RcppExport SEXP _beachmat_apply_delayed_round(SEXP raw_inputSEXP) {
+SEXP apply_delayed_round(SEXP raw_input, double digits);
+RcppExport SEXP _beachmat_apply_delayed_round(SEXP raw_inputSEXP, SEXP digitsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
+    Rcpp::traits::input_parameter< double >::type digits(digitsSEXP);
+    rcpp_result_gen = Rcpp::wrap(apply_delayed_round(raw_input, digits));
+    return rcpp_result_gen;
+END_RCPP
+}
+// apply_delayed_signif
+SEXP apply_delayed_signif(SEXP raw_input, double digits);
+RcppExport SEXP _beachmat_apply_delayed_signif(SEXP raw_inputSEXP, SEXP digitsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
-    rcpp_result_gen = Rcpp::wrap(apply_delayed_round(raw_input));
+    Rcpp::traits::input_parameter< double >::type digits(digitsSEXP);
+    rcpp_result_gen = Rcpp::wrap(apply_delayed_signif(raw_input, digits));
+    return rcpp_result_gen;
+END_RCPP
+}
+// apply_delayed_special_check
+SEXP apply_delayed_special_check(SEXP raw_input, const std::string& op);
+RcppExport SEXP _beachmat_apply_delayed_special_check(SEXP raw_inputSEXP, SEXP opSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type op(opSEXP);
+    rcpp_result_gen = Rcpp::wrap(apply_delayed_special_check(raw_input, op));
+    return rcpp_result_gen;
+END_RCPP
+}
+// apply_delayed_nary_operation
+SEXP apply_delayed_nary_operation(Rcpp::List input, std::string op, Rcpp::List extras, bool na_rm);
+RcppExport SEXP _beachmat_apply_delayed_nary_operation(SEXP inputSEXP, SEXP opSEXP, SEXP extrasSEXP, SEXP na_rmSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< std::string >::type op(opSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type extras(extrasSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    rcpp_result_gen = Rcpp::wrap(apply_delayed_nary_operation(input, op, extras, na_rm));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -129,6 +237,19 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// apply_delayed_clamp
+SEXP apply_delayed_clamp(SEXP raw_input, Rcpp::NumericVector val, bool row, std::string op);
+RcppExport SEXP _beachmat_apply_delayed_clamp(SEXP raw_inputSEXP, SEXP valSEXP, SEXP rowSEXP, SEXP opSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type val(valSEXP);
+    Rcpp::traits::input_parameter< bool >::type row(rowSEXP);
+    Rcpp::traits::input_parameter< std::string >::type op(opSEXP);
+    rcpp_result_gen = Rcpp::wrap(apply_delayed_clamp(raw_input, val, row, op));
+    return rcpp_result_gen;
+END_RCPP
+}
 // apply_delayed_subset
 SEXP apply_delayed_subset(SEXP raw_input, Rcpp::IntegerVector subset, bool row);
 RcppExport SEXP _beachmat_apply_delayed_subset(SEXP raw_inputSEXP, SEXP subsetSEXP, SEXP rowSEXP) {
@@ -162,6 +283,19 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// initialize_altrep_matrix
+SEXP initialize_altrep_matrix(Rcpp::RObject raw_x, int nrow, int ncol, bool check_na);
+RcppExport SEXP _beachmat_initialize_altrep_matrix(SEXP raw_xSEXP, SEXP nrowSEXP, SEXP ncolSEXP, SEXP check_naSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type raw_x(raw_xSEXP);
+    Rcpp::traits::input_parameter< int >::type nrow(nrowSEXP);
+    Rcpp::traits::input_parameter< int >::type ncol(ncolSEXP);
+    Rcpp::traits::input_parameter< bool >::type check_na(check_naSEXP);
+    rcpp_result_gen = Rcpp::wrap(initialize_altrep_matrix(raw_x, nrow, ncol, check_na));
+    return rcpp_result_gen;
+END_RCPP
+}
 // initialize_dense_matrix
 SEXP initialize_dense_matrix(Rcpp::RObject raw_x, int nrow, int ncol, bool check_na);
 RcppExport SEXP _beachmat_initialize_dense_matrix(SEXP raw_xSEXP, SEXP nrowSEXP, SEXP ncolSEXP, SEXP check_naSEXP) {
@@ -188,6 +322,34 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// set_executor_profiling
+Rcpp::LogicalVector set_executor_profiling(bool enabled);
+RcppExport SEXP _beachmat_set_executor_profiling(SEXP enabledSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< bool >::type enabled(enabledSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_executor_profiling(enabled));
+    return rcpp_result_gen;
+END_RCPP
+}
+// get_executor_profile
+Rcpp::List get_executor_profile();
+RcppExport SEXP _beachmat_get_executor_profile() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    rcpp_result_gen = Rcpp::wrap(get_executor_profile());
+    return rcpp_result_gen;
+END_RCPP
+}
+// reset_executor_profile
+SEXP reset_executor_profile();
+RcppExport SEXP _beachmat_reset_executor_profile() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    rcpp_result_gen = Rcpp::wrap(reset_executor_profile());
+    return rcpp_result_gen;
+END_RCPP
+}
 // fragment_sparse_rows
 Rcpp::List fragment_sparse_rows(Rcpp::IntegerVector i, Rcpp::IntegerVector p, Rcpp::IntegerVector limits);
 RcppExport SEXP _beachmat_fragment_sparse_rows(SEXP iSEXP, SEXP pSEXP, SEXP limitsSEXP) {
@@ -220,6 +382,72 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// reorient_sparse_matrix
+SEXP reorient_sparse_matrix(SEXP raw_input, int threads);
+RcppExport SEXP _beachmat_reorient_sparse_matrix(SEXP raw_inputSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(reorient_sparse_matrix(raw_input, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// initialize_rle_matrix
+SEXP initialize_rle_matrix(Rcpp::NumericVector values, Rcpp::IntegerVector lengths, int nrow, int ncol);
+RcppExport SEXP _beachmat_initialize_rle_matrix(SEXP valuesSEXP, SEXP lengthsSEXP, SEXP nrowSEXP, SEXP ncolSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type lengths(lengthsSEXP);
+    Rcpp::traits::input_parameter< int >::type nrow(nrowSEXP);
+    Rcpp::traits::input_parameter< int >::type ncol(ncolSEXP);
+    rcpp_result_gen = Rcpp::wrap(initialize_rle_matrix(values, lengths, nrow, ncol));
+    return rcpp_result_gen;
+END_RCPP
+}
+// seed_address
+std::string seed_address(SEXP x);
+RcppExport SEXP _beachmat_seed_address(SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(seed_address(x));
+    return rcpp_result_gen;
+END_RCPP
+}
+// export_shared_matrix
+Rcpp::List export_shared_matrix(SEXP raw_input, std::string name, int threads);
+RcppExport SEXP _beachmat_export_shared_matrix(SEXP raw_inputSEXP, SEXP nameSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
+    Rcpp::traits::input_parameter< std::string >::type name(nameSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(export_shared_matrix(raw_input, name, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// attach_shared_matrix
+SEXP attach_shared_matrix(std::string name);
+RcppExport SEXP _beachmat_attach_shared_matrix(SEXP nameSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< std::string >::type name(nameSEXP);
+    rcpp_result_gen = Rcpp::wrap(attach_shared_matrix(name));
+    return rcpp_result_gen;
+END_RCPP
+}
+// unlink_shared_matrix
+SEXP unlink_shared_matrix(std::string name);
+RcppExport SEXP _beachmat_unlink_shared_matrix(SEXP nameSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< std::string >::type name(nameSEXP);
+    rcpp_result_gen = Rcpp::wrap(unlink_shared_matrix(name));
+    return rcpp_result_gen;
+END_RCPP
+}
 // initialize_sparse_matrix
 SEXP initialize_sparse_matrix(Rcpp::RObject raw_x, Rcpp::RObject raw_i, Rcpp::RObject raw_p, int nrow, int ncol, bool byrow, bool check_na);
 RcppExport SEXP _beachmat_initialize_sparse_matrix(SEXP raw_xSEXP, SEXP raw_iSEXP, SEXP raw_pSEXP, SEXP nrowSEXP, SEXP ncolSEXP, SEXP byrowSEXP, SEXP check_naSEXP) {
@@ -249,6 +477,18 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// svt_to_csparse
+Rcpp::List svt_to_csparse(Rcpp::RObject seed, int nc, int threads);
+RcppExport SEXP _beachmat_svt_to_csparse(SEXP seedSEXP, SEXP ncSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< int >::type nc(ncSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(svt_to_csparse(seed, nc, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // tatami_dim
 Rcpp::IntegerVector tatami_dim(SEXP raw_input);
 RcppExport SEXP _beachmat_tatami_dim(SEXP raw_inputSEXP) {
@@ -341,53 +581,120 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// tatami_nonzero_counts
+Rcpp::NumericVector tatami_nonzero_counts(SEXP raw_input, bool row, int threads);
+RcppExport SEXP _beachmat_tatami_nonzero_counts(SEXP raw_inputSEXP, SEXP rowSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
+    Rcpp::traits::input_parameter< bool >::type row(rowSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(tatami_nonzero_counts(raw_input, row, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// tatami_which
+Rcpp::List tatami_which(SEXP raw_input, std::string op, double threshold, int threads);
+RcppExport SEXP _beachmat_tatami_which(SEXP raw_inputSEXP, SEXP opSEXP, SEXP thresholdSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
+    Rcpp::traits::input_parameter< std::string >::type op(opSEXP);
+    Rcpp::traits::input_parameter< double >::type threshold(thresholdSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(tatami_which(raw_input, op, threshold, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // tatami_realize
-SEXP tatami_realize(SEXP raw_input, int threads);
-RcppExport SEXP _beachmat_tatami_realize(SEXP raw_inputSEXP, SEXP threadsSEXP) {
+SEXP tatami_realize(SEXP raw_input, int threads, bool async);
+RcppExport SEXP _beachmat_tatami_realize(SEXP raw_inputSEXP, SEXP threadsSEXP, SEXP asyncSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
     Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
-    rcpp_result_gen = Rcpp::wrap(tatami_realize(raw_input, threads));
+    Rcpp::traits::input_parameter< bool >::type async(asyncSEXP);
+    rcpp_result_gen = Rcpp::wrap(tatami_realize(raw_input, threads, async));
     return rcpp_result_gen;
 END_RCPP
 }
 // tatami_multiply_vector
-Rcpp::NumericVector tatami_multiply_vector(SEXP raw_input, Rcpp::NumericVector other, bool right, int threads);
-RcppExport SEXP _beachmat_tatami_multiply_vector(SEXP raw_inputSEXP, SEXP otherSEXP, SEXP rightSEXP, SEXP threadsSEXP) {
+SEXP tatami_multiply_vector(SEXP raw_input, Rcpp::NumericVector other, bool right, int threads, bool async);
+RcppExport SEXP _beachmat_tatami_multiply_vector(SEXP raw_inputSEXP, SEXP otherSEXP, SEXP rightSEXP, SEXP threadsSEXP, SEXP asyncSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type other(otherSEXP);
     Rcpp::traits::input_parameter< bool >::type right(rightSEXP);
     Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
-    rcpp_result_gen = Rcpp::wrap(tatami_multiply_vector(raw_input, other, right, threads));
+    Rcpp::traits::input_parameter< bool >::type async(asyncSEXP);
+    rcpp_result_gen = Rcpp::wrap(tatami_multiply_vector(raw_input, other, right, threads, async));
     return rcpp_result_gen;
 END_RCPP
 }
 // tatami_multiply_columns
-Rcpp::NumericVector tatami_multiply_columns(SEXP raw_input, Rcpp::NumericMatrix other, bool right, int threads);
-RcppExport SEXP _beachmat_tatami_multiply_columns(SEXP raw_inputSEXP, SEXP otherSEXP, SEXP rightSEXP, SEXP threadsSEXP) {
+SEXP tatami_multiply_columns(SEXP raw_input, Rcpp::NumericMatrix other, bool right, int threads, bool async);
+RcppExport SEXP _beachmat_tatami_multiply_columns(SEXP raw_inputSEXP, SEXP otherSEXP, SEXP rightSEXP, SEXP threadsSEXP, SEXP asyncSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type other(otherSEXP);
     Rcpp::traits::input_parameter< bool >::type right(rightSEXP);
     Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
-    rcpp_result_gen = Rcpp::wrap(tatami_multiply_columns(raw_input, other, right, threads));
+    Rcpp::traits::input_parameter< bool >::type async(asyncSEXP);
+    rcpp_result_gen = Rcpp::wrap(tatami_multiply_columns(raw_input, other, right, threads, async));
     return rcpp_result_gen;
 END_RCPP
 }
 // tatami_multiply_matrix
-Rcpp::NumericVector tatami_multiply_matrix(SEXP raw_input, SEXP more_input, bool right, int threads);
-RcppExport SEXP _beachmat_tatami_multiply_matrix(SEXP raw_inputSEXP, SEXP more_inputSEXP, SEXP rightSEXP, SEXP threadsSEXP) {
+SEXP tatami_multiply_matrix(SEXP raw_input, SEXP more_input, bool right, int threads, bool async);
+RcppExport SEXP _beachmat_tatami_multiply_matrix(SEXP raw_inputSEXP, SEXP more_inputSEXP, SEXP rightSEXP, SEXP threadsSEXP, SEXP asyncSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
     Rcpp::traits::input_parameter< SEXP >::type more_input(more_inputSEXP);
     Rcpp::traits::input_parameter< bool >::type right(rightSEXP);
     Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
-    rcpp_result_gen = Rcpp::wrap(tatami_multiply_matrix(raw_input, more_input, right, threads));
+    Rcpp::traits::input_parameter< bool >::type async(asyncSEXP);
+    rcpp_result_gen = Rcpp::wrap(tatami_multiply_matrix(raw_input, more_input, right, threads, async));
+    return rcpp_result_gen;
+END_RCPP
+}
+// test_sparse_builder
+SEXP test_sparse_builder(SEXP raw_input, bool row, bool two_pass, bool bound, int threads);
+RcppExport SEXP _beachmat_test_sparse_builder(SEXP raw_inputSEXP, SEXP rowSEXP, SEXP two_passSEXP, SEXP boundSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
+    Rcpp::traits::input_parameter< bool >::type row(rowSEXP);
+    Rcpp::traits::input_parameter< bool >::type two_pass(two_passSEXP);
+    Rcpp::traits::input_parameter< bool >::type bound(boundSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(test_sparse_builder(raw_input, row, two_pass, bound, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// test_dense_builder
+SEXP test_dense_builder(SEXP raw_input, bool row, bool bound, int threads);
+RcppExport SEXP _beachmat_test_dense_builder(SEXP raw_inputSEXP, SEXP rowSEXP, SEXP boundSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type raw_input(raw_inputSEXP);
+    Rcpp::traits::input_parameter< bool >::type row(rowSEXP);
+    Rcpp::traits::input_parameter< bool >::type bound(boundSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(test_dense_builder(raw_input, row, bound, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// set_thread_pool
+Rcpp::List set_thread_pool(Rcpp::Nullable<Rcpp::IntegerVector> size, Rcpp::Nullable<Rcpp::IntegerVector> spin);
+RcppExport SEXP _beachmat_set_thread_pool(SEXP sizeSEXP, SEXP spinSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type size(sizeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type spin(spinSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_thread_pool(size, spin));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -403,26 +710,48 @@ END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
+    {"_beachmat_tatami_async_poll", (DL_FUNC) &_beachmat_tatami_async_poll, 1},
+    {"_beachmat_tatami_async_deferred", (DL_FUNC) &_beachmat_tatami_async_deferred, 1},
+    {"_beachmat_tatami_async_wait", (DL_FUNC) &_beachmat_tatami_async_wait, 2},
+    {"_beachmat_tatami_async_result", (DL_FUNC) &_beachmat_tatami_async_result, 1},
+    {"_beachmat_tatami_async_cancel", (DL_FUNC) &_beachmat_tatami_async_cancel, 1},
+    {"_beachmat_apply_delayed_callback", (DL_FUNC) &_beachmat_apply_delayed_callback, 2},
+    {"_beachmat_set_executor_coalescing", (DL_FUNC) &_beachmat_set_executor_coalescing, 1},
     {"_beachmat_initialize_constant_matrix", (DL_FUNC) &_beachmat_initialize_constant_matrix, 3},
     {"_beachmat_apply_delayed_binary_operation", (DL_FUNC) &_beachmat_apply_delayed_binary_operation, 3},
     {"_beachmat_apply_delayed_log", (DL_FUNC) &_beachmat_apply_delayed_log, 2},
     {"_beachmat_apply_delayed_unary_math", (DL_FUNC) &_beachmat_apply_delayed_unary_math, 2},
-    {"_beachmat_apply_delayed_round", (DL_FUNC) &_beachmat_apply_delayed_round, 1},
+    {"_beachmat_apply_delayed_round", (DL_FUNC) &_beachmat_apply_delayed_round, 2},
+    {"_beachmat_apply_delayed_signif", (DL_FUNC) &_beachmat_apply_delayed_signif, 2},
+    {"_beachmat_apply_delayed_special_check", (DL_FUNC) &_beachmat_apply_delayed_special_check, 2},
+    {"_beachmat_apply_delayed_nary_operation", (DL_FUNC) &_beachmat_apply_delayed_nary_operation, 4},
     {"_beachmat_apply_delayed_associative_arithmetic", (DL_FUNC) &_beachmat_apply_delayed_associative_arithmetic, 4},
     {"_beachmat_apply_delayed_nonassociative_arithmetic", (DL_FUNC) &_beachmat_apply_delayed_nonassociative_arithmetic, 5},
     {"_beachmat_apply_delayed_comparison", (DL_FUNC) &_beachmat_apply_delayed_comparison, 4},
     {"_beachmat_apply_delayed_boolean", (DL_FUNC) &_beachmat_apply_delayed_boolean, 4},
     {"_beachmat_apply_delayed_boolean_not", (DL_FUNC) &_beachmat_apply_delayed_boolean_not, 1},
+    {"_beachmat_apply_delayed_clamp", (DL_FUNC) &_beachmat_apply_delayed_clamp, 4},
     {"_beachmat_apply_delayed_subset", (DL_FUNC) &_beachmat_apply_delayed_subset, 3},
     {"_beachmat_apply_delayed_transpose", (DL_FUNC) &_beachmat_apply_delayed_transpose, 1},
     {"_beachmat_apply_delayed_bind", (DL_FUNC) &_beachmat_apply_delayed_bind, 2},
+    {"_beachmat_initialize_altrep_matrix", (DL_FUNC) &_beachmat_initialize_altrep_matrix, 4},
     {"_beachmat_initialize_dense_matrix", (DL_FUNC) &_beachmat_initialize_dense_matrix, 4},
     {"_beachmat_initialize_dense_matrix_from_vector", (DL_FUNC) &_beachmat_initialize_dense_matrix_from_vector, 4},
+    {"_beachmat_set_executor_profiling", (DL_FUNC) &_beachmat_set_executor_profiling, 1},
+    {"_beachmat_get_executor_profile", (DL_FUNC) &_beachmat_get_executor_profile, 0},
+    {"_beachmat_reset_executor_profile", (DL_FUNC) &_beachmat_reset_executor_profile, 0},
     {"_beachmat_fragment_sparse_rows", (DL_FUNC) &_beachmat_fragment_sparse_rows, 3},
     {"_beachmat_sparse_subset_index", (DL_FUNC) &_beachmat_sparse_subset_index, 2},
     {"_beachmat_get_executor", (DL_FUNC) &_beachmat_get_executor, 0},
+    {"_beachmat_reorient_sparse_matrix", (DL_FUNC) &_beachmat_reorient_sparse_matrix, 2},
+    {"_beachmat_initialize_rle_matrix", (DL_FUNC) &_beachmat_initialize_rle_matrix, 4},
+    {"_beachmat_seed_address", (DL_FUNC) &_beachmat_seed_address, 1},
+    {"_beachmat_export_shared_matrix", (DL_FUNC) &_beachmat_export_shared_matrix, 3},
+    {"_beachmat_attach_shared_matrix", (DL_FUNC) &_beachmat_attach_shared_matrix, 1},
+    {"_beachmat_unlink_shared_matrix", (DL_FUNC) &_beachmat_unlink_shared_matrix, 1},
     {"_beachmat_initialize_sparse_matrix", (DL_FUNC) &_beachmat_initialize_sparse_matrix, 7},
     {"_beachmat_initialize_SVT_SparseMatrix", (DL_FUNC) &_beachmat_initialize_SVT_SparseMatrix, 4},
+    {"_beachmat_svt_to_csparse", (DL_FUNC) &_beachmat_svt_to_csparse, 3},
     {"_beachmat_tatami_dim", (DL_FUNC) &_beachmat_tatami_dim, 1},
     {"_beachmat_tatami_is_sparse", (DL_FUNC) &_beachmat_tatami_is_sparse, 1},
     {"_beachmat_tatami_prefer_rows", (DL_FUNC) &_beachmat_tatami_prefer_rows, 1},
@@ -431,10 +760,15 @@ static const R_CallMethodDef CallEntries[] = {
     {"_beachmat_tatami_sums_by_group", (DL_FUNC) &_beachmat_tatami_sums_by_group, 5},
     {"_beachmat_tatami_medians", (DL_FUNC) &_beachmat_tatami_medians, 3},
     {"_beachmat_tatami_nan_counts", (DL_FUNC) &_beachmat_tatami_nan_counts, 3},
-    {"_beachmat_tatami_realize", (DL_FUNC) &_beachmat_tatami_realize, 2},
-    {"_beachmat_tatami_multiply_vector", (DL_FUNC) &_beachmat_tatami_multiply_vector, 4},
-    {"_beachmat_tatami_multiply_columns", (DL_FUNC) &_beachmat_tatami_multiply_columns, 4},
-    {"_beachmat_tatami_multiply_matrix", (DL_FUNC) &_beachmat_tatami_multiply_matrix, 4},
+    {"_beachmat_tatami_nonzero_counts", (DL_FUNC) &_beachmat_tatami_nonzero_counts, 3},
+    {"_beachmat_tatami_which", (DL_FUNC) &_beachmat_tatami_which, 4},
+    {"_beachmat_tatami_realize", (DL_FUNC) &_beachmat_tatami_realize, 3},
+    {"_beachmat_tatami_multiply_vector", (DL_FUNC) &_beachmat_tatami_multiply_vector, 5},
+    {"_beachmat_tatami_multiply_columns", (DL_FUNC) &_beachmat_tatami_multiply_columns, 5},
+    {"_beachmat_tatami_multiply_matrix", (DL_FUNC) &_beachmat_tatami_multiply_matrix, 5},
+    {"_beachmat_test_sparse_builder", (DL_FUNC) &_beachmat_test_sparse_builder, 5},
+    {"_beachmat_test_dense_builder", (DL_FUNC) &_beachmat_test_dense_builder, 4},
+    {"_beachmat_set_thread_pool", (DL_FUNC) &_beachmat_set_thread_pool, 2},
     {"_beachmat_initialize_unknown_matrix", (DL_FUNC) &_beachmat_initialize_unknown_matrix, 1},
     {NULL, NULL, 0}
 };
@@ -0,0 +1,251 @@
+#ifndef BEACHMAT_ALTREP_MATRIX_H
+#define BEACHMAT_ALTREP_MATRIX_H
+
+#include "Rtatami.h"
+#include "executor_profile.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Check whether an R vector is an ALTREP object without a cheap data pointer, e.g., a file-backed vector.
+ * Calling DATAPTR() on such vectors would force the entire vector into memory.
+ */
+inline bool is_altrep_without_pointer(SEXP x) {
+    return ALTREP(x) && DATAPTR_OR_NULL(x) == NULL;
+}
+
+inline R_xlen_t altrep_get_region(SEXP x, R_xlen_t start, R_xlen_t n, int* buffer) {
+    if (TYPEOF(x) == LGLSXP) {
+        return LOGICAL_GET_REGION(x, start, n, buffer);
+    } else {
+        return INTEGER_GET_REGION(x, start, n, buffer);
+    }
+}
+
+inline R_xlen_t altrep_get_region(SEXP x, R_xlen_t start, R_xlen_t n, double* buffer) {
+    return REAL_GET_REGION(x, start, n, buffer);
+}
+
+/**
+ * Loads a chunk of contiguous rows (or columns) from a column-major ALTREP vector with the *_GET_REGION methods.
+ * All regions for a chunk are requested in a single call to the main thread, as the ALTREP methods may evaluate R code.
+ * Chunks span the selected subset of the other dimension and are sized according to the block size.
+ */
+template<bool oracle_, typename Value_, typename Index_, typename Input_>
+class AltrepDenseExtractor final : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+public:
+    AltrepDenseExtractor(
+        SEXP x,
+        Index_ nrow,
+        double block_size,
+        tatami::MaybeOracle<oracle_, Index_> oracle,
+        bool row,
+        Index_ primary,
+        std::vector<Index_> secondary) :
+        my_x(x),
+        my_nrow(nrow),
+        my_oracle(std::move(oracle)),
+        my_row(row),
+        my_primary(primary),
+        my_secondary(std::move(secondary))
+    {
+        double per_chunk = block_size / (sizeof(double) * std::max<std::size_t>(my_secondary.size(), 1));
+        my_chunk_size = std::max(1, static_cast<int>(std::min(per_chunk, static_cast<double>(my_primary))));
+    }
+
+    const Value_* fetch(Index_ i, Value_* buffer) {
+        if constexpr(oracle_) {
+            i = my_oracle->get(my_used);
+            ++my_used;
+        }
+
+        if (i < my_chunk_start || i >= my_chunk_start + my_chunk_length) {
+            load(i);
+        }
+
+        std::size_t nsecondary = my_secondary.size();
+        auto src = my_chunk.data() + static_cast<std::size_t>(i - my_chunk_start) * nsecondary;
+        std::copy_n(src, nsecondary, buffer);
+        return buffer;
+    }
+
+private:
+    SEXP my_x;
+    Index_ my_nrow;
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    typename std::conditional<oracle_, std::size_t, bool>::type my_used = 0;
+    bool my_row;
+    Index_ my_primary;
+    std::vector<Index_> my_secondary;
+
+    int my_chunk_size;
+    Index_ my_chunk_start = 0, my_chunk_length = 0;
+    std::vector<Value_> my_chunk; // each row/column of the primary dimension is contiguous.
+    std::vector<Input_> my_region;
+
+    void get_region(R_xlen_t start, R_xlen_t n) {
+        if (altrep_get_region(my_x, start, n, my_region.data()) != n) {
+            throw std::runtime_error("failed to extract a region from an ALTREP vector");
+        }
+    }
+
+    void load(Index_ i) {
+        my_chunk_start = (i / my_chunk_size) * my_chunk_size;
+        my_chunk_length = std::min(static_cast<Index_>(my_chunk_size), static_cast<Index_>(my_primary - my_chunk_start));
+        std::size_t nsecondary = my_secondary.size();
+        my_chunk.resize(static_cast<std::size_t>(my_chunk_length) * nsecondary);
+        if (nsecondary == 0) {
+            return;
+        }
+
+        profiled_run([&]() -> void {
+            if (my_row) {
+                // Each selected column contributes a contiguous stretch of rows to the chunk.
+                my_region.resize(my_chunk_length);
+                for (std::size_t s = 0; s < nsecondary; ++s) {
+                    get_region(static_cast<R_xlen_t>(my_secondary[s]) * my_nrow + my_chunk_start, my_chunk_length);
+                    for (Index_ p = 0; p < my_chunk_length; ++p) {
+                        my_chunk[static_cast<std::size_t>(p) * nsecondary + s] = my_region[p];
+                    }
+                }
+
+            } else {
+                // Each column in the chunk is read across the span of the selected rows.
+                Index_ first = my_secondary.front();
+                Index_ span = my_secondary.back() - first + 1;
+                my_region.resize(span);
+                for (Index_ p = 0; p < my_chunk_length; ++p) {
+                    get_region(static_cast<R_xlen_t>(my_chunk_start + p) * my_nrow + first, span);
+                    auto out = my_chunk.data() + static_cast<std::size_t>(p) * nsecondary;
+                    for (std::size_t s = 0; s < nsecondary; ++s) {
+                        out[s] = my_region[my_secondary[s] - first];
+                    }
+                }
+            }
+        });
+    }
+};
+
+/**
+ * Dense column-major matrix that reads from an ALTREP vector on demand, without ever materializing the entire vector.
+ * This is used for ALTREP vectors that do not provide a cheap data pointer, e.g., memory-mapped or file-backed vectors.
+ * The vector should be protected from garbage collection by the caller.
+ */
+template<typename Value_, typename Index_, typename Input_>
+class AltrepDenseMatrix final : public tatami::Matrix<Value_, Index_> {
+public:
+    AltrepDenseMatrix(SEXP x, Index_ nrow, Index_ ncol, double block_size) : my_x(x), my_nrow(nrow), my_ncol(ncol), my_block_size(block_size) {
+        if (static_cast<R_xlen_t>(nrow) * static_cast<R_xlen_t>(ncol) != Rf_xlength(x)) {
+            throw std::runtime_error("length of the ALTREP vector should be equal to the product of the dimensions");
+        }
+    }
+
+private:
+    SEXP my_x;
+    Index_ my_nrow, my_ncol;
+    double my_block_size;
+
+public:
+    Index_ nrow() const {
+        return my_nrow;
+    }
+
+    Index_ ncol() const {
+        return my_ncol;
+    }
+
+    bool is_sparse() const {
+        return false;
+    }
+
+    double is_sparse_proportion() const {
+        return 0;
+    }
+
+    bool prefer_rows() const {
+        return false;
+    }
+
+    double prefer_rows_proportion() const {
+        return 0;
+    }
+
+    bool uses_oracle(bool) const {
+        return false;
+    }
+
+    using tatami::Matrix<Value_, Index_>::dense;
+
+    using tatami::Matrix<Value_, Index_>::sparse;
+
+private:
+    template<bool oracle_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > dense_internal(bool row, tatami::MaybeOracle<oracle_, Index_> oracle, std::vector<Index_> secondary) const {
+        Index_ primary = (row ? my_nrow : my_ncol);
+        return std::make_unique<AltrepDenseExtractor<oracle_, Value_, Index_, Input_> >(my_x, my_nrow, my_block_size, std::move(oracle), row, primary, std::move(secondary));
+    }
+
+    std::vector<Index_> block_secondary(Index_ block_start, Index_ block_length) const {
+        std::vector<Index_> secondary(block_length);
+        std::iota(secondary.begin(), secondary.end(), block_start);
+        return secondary;
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, const tatami::Options&) const {
+        return dense_internal<false>(row, false, block_secondary(0, row ? my_ncol : my_nrow));
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, Index_ block_start, Index_ block_length, const tatami::Options&) const {
+        return dense_internal<false>(row, false, block_secondary(block_start, block_length));
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options&) const {
+        return dense_internal<false>(row, false, std::vector<Index_>(indices_ptr->begin(), indices_ptr->end()));
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, const tatami::Options& opt) const {
+        return std::make_unique<tatami::FullSparsifiedWrapper<false, Value_, Index_> >(dense(row, opt), (row ? my_ncol : my_nrow), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return std::make_unique<tatami::BlockSparsifiedWrapper<false, Value_, Index_> >(dense(row, block_start, block_length, opt), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        auto ext = dense(row, indices_ptr, opt);
+        return std::make_unique<tatami::IndexSparsifiedWrapper<false, Value_, Index_> >(std::move(ext), std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options&) const {
+        return dense_internal<true>(row, std::move(oracle), block_secondary(0, row ? my_ncol : my_nrow));
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options&) const {
+        return dense_internal<true>(row, std::move(oracle), block_secondary(block_start, block_length));
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options&) const {
+        return dense_internal<true>(row, std::move(oracle), std::vector<Index_>(indices_ptr->begin(), indices_ptr->end()));
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return std::make_unique<tatami::FullSparsifiedWrapper<true, Value_, Index_> >(dense(row, std::move(oracle), opt), (row ? my_ncol : my_nrow), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return std::make_unique<tatami::BlockSparsifiedWrapper<true, Value_, Index_> >(dense(row, std::move(oracle), block_start, block_length, opt), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        auto ext = dense(row, std::move(oracle), indices_ptr, opt);
+        return std::make_unique<tatami::IndexSparsifiedWrapper<true, Value_, Index_> >(std::move(ext), std::move(indices_ptr), opt);
+    }
+};
+
+#endif
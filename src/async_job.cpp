@@ -0,0 +1,32 @@
+#include "async_job.h"
+
+//[[Rcpp::export(rng=false)]]
+Rcpp::LogicalVector tatami_async_poll(SEXP raw_job) {
+    Rcpp::XPtr<AsyncJob> job(raw_job);
+    return Rcpp::LogicalVector::create(job->poll());
+}
+
+//[[Rcpp::export(rng=false)]]
+Rcpp::LogicalVector tatami_async_deferred(SEXP raw_job) {
+    Rcpp::XPtr<AsyncJob> job(raw_job);
+    return Rcpp::LogicalVector::create(job->deferred());
+}
+
+//[[Rcpp::export(rng=false)]]
+Rcpp::LogicalVector tatami_async_wait(SEXP raw_job, double timeout) {
+    Rcpp::XPtr<AsyncJob> job(raw_job);
+    return Rcpp::LogicalVector::create(job->wait(timeout));
+}
+
+//[[Rcpp::export(rng=false)]]
+SEXP tatami_async_result(SEXP raw_job) {
+    Rcpp::XPtr<AsyncJob> job(raw_job);
+    return job->result();
+}
+
+//[[Rcpp::export(rng=false)]]
+SEXP tatami_async_cancel(SEXP raw_job) {
+    Rcpp::XPtr<AsyncJob> job(raw_job);
+    job->cancel();
+    return R_NilValue;
+}
@@ -0,0 +1,191 @@
+#ifndef BEACHMAT_ASYNC_JOB_H
+#define BEACHMAT_ASYNC_JOB_H
+
+#include "Rtatami.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+/**
+ * A computation that is split into two parts.
+ * `compute` does the heavy lifting and may be run on any thread, so it must not call the R API.
+ * It should periodically check the supplied flag and return early if the computation has been cancelled.
+ * `finalize` is always run on the main thread after `compute` finishes, and creates the R object to be returned.
+ */
+struct TatamiTask {
+    std::function<void(const std::atomic<bool>&)> compute;
+    std::function<Rcpp::RObject()> finalize;
+};
+
+/**
+ * Run a task to completion on the current thread.
+ */
+inline Rcpp::RObject run_task(TatamiTask& task) {
+    std::atomic<bool> cancelled = false;
+    task.compute(cancelled);
+    return task.finalize();
+}
+
+/**
+ * Run a task on a background thread.
+ * The background thread uses a `Rtatami::DetachedScope` so that it does not interfere with the thread pool or executor on the main thread.
+ *
+ * If the task involves matrices that call back into R via `run_on_main()` (e.g., callback or ALTREP matrices),
+ * their requests are submitted to the job's own `Rtatami::DetachedExecutor`.
+ * These requests are run on the main thread whenever it checks in on the job, i.e., in `poll()`, `wait()` and `result()`.
+ *
+ * Matrices that call into R via the process-wide `tatami_r::executor()` (i.e., the **tatami_r** fallback for R-backed matrices and nodes from other packages)
+ * cannot be run in the background, as that executor would run R code directly on the background threads.
+ * Such tasks are deferred until the main thread calls `result()` or `wait()` without a timeout, at which point they are run on the main thread.
+ */
+class AsyncJob {
+public:
+    AsyncJob(TatamiTask task, bool deferred) : my_task(std::move(task)), my_deferred(deferred) {
+        if (!my_deferred) {
+            my_thread = std::thread([this]() -> void {
+                Rtatami::DetachedScope scope(&my_executor);
+                compute();
+            });
+        }
+    }
+
+    ~AsyncJob() {
+        // We can't service any more R calls as the destructor may be called during garbage collection,
+        // so any pending requests from the job will fail, allowing its threads to finish.
+        my_cancelled = true;
+        my_executor.close("job was cancelled");
+        if (my_thread.joinable()) {
+            my_thread.join();
+        }
+    }
+
+    AsyncJob(const AsyncJob&) = delete;
+    AsyncJob& operator=(const AsyncJob&) = delete;
+
+public:
+    /**
+     * Run any pending requests from the job and report whether the job has finished.
+     * This should only be called from the main thread.
+     */
+    bool poll() {
+        my_executor.service();
+        return finished();
+    }
+
+    bool deferred() const {
+        return my_deferred;
+    }
+
+    /**
+     * Wait for the job to finish, running any requests from the job on the main thread in the meantime.
+     * A negative `timeout` (in seconds) will wait indefinitely.
+     * User interrupts are checked periodically.
+     * Returns whether the job has finished.
+     */
+    bool wait(double timeout) {
+        if (my_deferred && !finished()) {
+            // A deferred job can't be interrupted once it starts, so we only run it if we're willing to wait indefinitely.
+            if (timeout >= 0) {
+                return false;
+            }
+            compute();
+            return true;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        while (true) {
+            my_executor.service();
+            if (finished()) {
+                return true;
+            }
+
+            auto slice = std::chrono::milliseconds(100);
+            if (timeout >= 0) {
+                auto remaining = std::chrono::duration<double>(timeout) - (std::chrono::steady_clock::now() - start);
+                if (remaining.count() <= 0) {
+                    return false;
+                }
+                slice = std::min(slice, std::chrono::duration_cast<std::chrono::milliseconds>(remaining) + std::chrono::milliseconds(1));
+            }
+
+            // Wakes up early if the job submits a request or finishes.
+            my_executor.wait_for(slice, [&]() -> bool { return finished(); });
+            Rcpp::checkUserInterrupt();
+        }
+    }
+
+    void cancel() {
+        // Cancelling a finished job is a no-op, so that its result can still be retrieved.
+        std::lock_guard<std::mutex> lck(my_lock);
+        if (!finished()) {
+            my_cancelled = true;
+        }
+    }
+
+    bool cancelled() const {
+        return my_cancelled.load();
+    }
+
+    Rcpp::RObject result() {
+        wait(-1);
+        if (my_thread.joinable()) {
+            my_thread.join();
+        }
+
+        if (!my_error.empty()) {
+            throw std::runtime_error(my_error);
+        }
+        if (my_cancelled) {
+            throw std::runtime_error("job was cancelled");
+        }
+        if (!my_finalized) {
+            my_result = my_task.finalize();
+            my_finalized = true;
+        }
+        return my_result;
+    }
+
+private:
+    TatamiTask my_task;
+    bool my_deferred;
+    Rtatami::DetachedExecutor my_executor;
+    std::thread my_thread;
+
+    std::mutex my_lock;
+    std::atomic<bool> my_cancelled = false;
+    std::atomic<bool> my_finished = false;
+    std::string my_error;
+
+    bool my_finalized = false;
+    Rcpp::RObject my_result;
+
+    bool finished() const {
+        return my_finished.load(std::memory_order_acquire);
+    }
+
+    void compute() {
+        if (!my_cancelled) {
+            try {
+                my_task.compute(my_cancelled);
+            } catch (std::exception& e) {
+                my_error = e.what();
+            } catch (...) {
+                my_error = "unknown C++ exception";
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lck(my_lock);
+            my_finished.store(true, std::memory_order_release);
+        }
+        my_executor.notify();
+    }
+};
+
+#endif
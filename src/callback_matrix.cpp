@@ -0,0 +1,30 @@
+#include "Rtatami.h"
+#include "Rcpp.h"
+
+#include "callback_matrix.h"
+#include "executor_profile.h"
+#include "node_info.h"
+
+//[[Rcpp::export(rng=false)]]
+SEXP apply_delayed_callback(SEXP raw_input, Rcpp::RObject op) {
+    Rtatami::BoundNumericPointer input(raw_input);
+
+    Rcpp::Environment beachmat = Rcpp::Environment::namespace_env("beachmat");
+    Rcpp::Function fun = beachmat[".apply_callback_block"];
+    Rcpp::Environment delayedarray = Rcpp::Environment::namespace_env("DelayedArray");
+    Rcpp::Function get_block_size = delayedarray["getAutoBlockSize"];
+    double block_size = Rcpp::as<double>(get_block_size());
+
+    auto output = Rtatami::new_BoundNumericMatrix();
+    auto context = std::make_shared<const CallbackContext>(op, fun, block_size);
+    output->ptr.reset(new CallbackMatrix<double, int>(input->ptr, std::move(context)));
+
+    if (executor_profile().enabled()) {
+        auto profiled = std::make_shared<ProfiledMatrix<double, int> >(std::move(output->ptr));
+        output->ptr = std::move(profiled);
+    }
+
+    output->original = input->original; // copying the reference to propagate GC protection.
+    annotate_node(output, "apply_delayed_callback", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("op") = op));
+    return output;
+}
@@ -0,0 +1,278 @@
+#ifndef BEACHMAT_CALLBACK_MATRIX_H
+#define BEACHMAT_CALLBACK_MATRIX_H
+
+#include "Rtatami.h"
+#include "executor_profile.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * R objects that are used by a CallbackMatrix to transform each block.
+ * These are only ever touched on the main thread, via the executor.
+ */
+struct CallbackContext {
+    CallbackContext(Rcpp::RObject op, Rcpp::Function fun, double block_size) :
+        op(std::move(op)), fun(std::move(fun)), block_size(block_size) {}
+
+    Rcpp::RObject op;
+    Rcpp::Function fun;
+    double block_size;
+};
+
+/**
+ * Extracts a chunk of contiguous rows (or columns) from the child matrix in C++,
+ * then calls back into R to apply the operation to the entire chunk at once.
+ * Chunks span the selected subset of the other dimension and are sized according to the block size.
+ */
+template<bool oracle_, typename Value_, typename Index_>
+class CallbackDenseExtractor final : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+public:
+    CallbackDenseExtractor(
+        const CallbackContext* context,
+        std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > child,
+        tatami::MaybeOracle<oracle_, Index_> oracle,
+        bool row,
+        Index_ primary,
+        std::vector<Index_> secondary) :
+        my_context(context),
+        my_child(std::move(child)),
+        my_oracle(std::move(oracle)),
+        my_row(row),
+        my_primary(primary),
+        my_secondary(std::move(secondary)),
+        my_buffer(my_secondary.size())
+    {
+        double per_chunk = my_context->block_size / (sizeof(double) * std::max<std::size_t>(my_secondary.size(), 1));
+        my_chunk_size = std::max(1, static_cast<int>(std::min(per_chunk, static_cast<double>(my_primary))));
+    }
+
+    const Value_* fetch(Index_ i, Value_* buffer) {
+        if constexpr(oracle_) {
+            i = my_oracle->get(my_used);
+            ++my_used;
+        }
+
+        if (i < my_chunk_start || i >= my_chunk_start + my_chunk_length) {
+            load(i);
+        }
+
+        std::size_t nsecondary = my_secondary.size();
+        auto src = my_chunk.data() + static_cast<std::size_t>(i - my_chunk_start) * nsecondary;
+        std::copy_n(src, nsecondary, buffer);
+        return buffer;
+    }
+
+private:
+    const CallbackContext* my_context;
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > my_child;
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    typename std::conditional<oracle_, std::size_t, bool>::type my_used = 0;
+    bool my_row;
+    Index_ my_primary;
+    std::vector<Index_> my_secondary;
+
+    int my_chunk_size;
+    Index_ my_chunk_start = 0, my_chunk_length = 0;
+    std::vector<Value_> my_chunk; // each row/column of the primary dimension is contiguous.
+    std::vector<Value_> my_buffer;
+
+    void load(Index_ i) {
+        my_chunk_start = (i / my_chunk_size) * my_chunk_size;
+        my_chunk_length = std::min(static_cast<Index_>(my_chunk_size), static_cast<Index_>(my_primary - my_chunk_start));
+        std::size_t nsecondary = my_secondary.size();
+        my_chunk.resize(static_cast<std::size_t>(my_chunk_length) * nsecondary);
+
+        for (Index_ p = 0; p < my_chunk_length; ++p) {
+            auto out = my_chunk.data() + static_cast<std::size_t>(p) * nsecondary;
+            auto ptr = my_child->fetch(my_chunk_start + p, my_buffer.data());
+            tatami::copy_n(ptr, nsecondary, out);
+        }
+
+        profiled_run([&]() -> void {
+            Rcpp::IntegerVector primary(my_chunk_length);
+            std::iota(primary.begin(), primary.end(), my_chunk_start + 1); // 1-based.
+            Rcpp::IntegerVector secondary(my_secondary.begin(), my_secondary.end());
+            for (auto& s : secondary) {
+                ++s;
+            }
+
+            // The R block is column-major, so row chunks need to be transposed on the way in and out.
+            Rcpp::NumericMatrix block(my_row ? my_chunk_length : nsecondary, my_row ? nsecondary : my_chunk_length);
+            double* bptr = static_cast<double*>(block.begin());
+            if (my_row) {
+                for (Index_ p = 0; p < my_chunk_length; ++p) {
+                    auto in = my_chunk.data() + static_cast<std::size_t>(p) * nsecondary;
+                    for (std::size_t s = 0; s < nsecondary; ++s) {
+                        bptr[s * my_chunk_length + p] = in[s];
+                    }
+                }
+            } else {
+                std::copy(my_chunk.begin(), my_chunk.end(), bptr);
+            }
+
+            Rcpp::NumericVector result(my_context->fun(my_context->op, block, my_row ? primary : secondary, my_row ? secondary : primary));
+            if (static_cast<std::size_t>(result.size()) != my_chunk.size()) {
+                throw std::runtime_error("R callback should return a block of the same dimensions");
+            }
+
+            const double* rptr = static_cast<const double*>(result.begin());
+            if (my_row) {
+                for (Index_ p = 0; p < my_chunk_length; ++p) {
+                    auto out = my_chunk.data() + static_cast<std::size_t>(p) * nsecondary;
+                    for (std::size_t s = 0; s < nsecondary; ++s) {
+                        out[s] = rptr[s * my_chunk_length + p];
+                    }
+                }
+            } else {
+                std::copy_n(rptr, my_chunk.size(), my_chunk.data());
+            }
+        });
+    }
+};
+
+/**
+ * Applies an operation that is not natively supported by calling back into R on blocks of the child matrix.
+ * The child is still extracted in C++, so only the operation itself is evaluated in R.
+ * The output is always treated as dense, as we don't know whether the operation preserves sparsity.
+ */
+template<typename Value_, typename Index_>
+class CallbackMatrix final : public tatami::Matrix<Value_, Index_> {
+public:
+    CallbackMatrix(std::shared_ptr<const tatami::Matrix<Value_, Index_> > matrix, std::shared_ptr<const CallbackContext> context) :
+        my_matrix(std::move(matrix)), my_context(std::move(context)) {}
+
+private:
+    std::shared_ptr<const tatami::Matrix<Value_, Index_> > my_matrix;
+    std::shared_ptr<const CallbackContext> my_context;
+
+public:
+    Index_ nrow() const {
+        return my_matrix->nrow();
+    }
+
+    Index_ ncol() const {
+        return my_matrix->ncol();
+    }
+
+    bool is_sparse() const {
+        return false;
+    }
+
+    double is_sparse_proportion() const {
+        return 0;
+    }
+
+    bool prefer_rows() const {
+        return my_matrix->prefer_rows();
+    }
+
+    double prefer_rows_proportion() const {
+        return my_matrix->prefer_rows_proportion();
+    }
+
+    bool uses_oracle(bool) const {
+        return false;
+    }
+
+    using tatami::Matrix<Value_, Index_>::dense;
+
+    using tatami::Matrix<Value_, Index_>::sparse;
+
+private:
+    template<bool oracle_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > dense_internal(
+        bool row,
+        std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > child,
+        tatami::MaybeOracle<oracle_, Index_> oracle,
+        std::vector<Index_> secondary) const
+    {
+        Index_ primary = (row ? my_matrix->nrow() : my_matrix->ncol());
+        return std::make_unique<CallbackDenseExtractor<oracle_, Value_, Index_> >(my_context.get(), std::move(child), std::move(oracle), row, primary, std::move(secondary));
+    }
+
+    std::vector<Index_> full_secondary(bool row) const {
+        std::vector<Index_> secondary(row ? my_matrix->ncol() : my_matrix->nrow());
+        std::iota(secondary.begin(), secondary.end(), static_cast<Index_>(0));
+        return secondary;
+    }
+
+    static std::vector<Index_> block_secondary(Index_ block_start, Index_ block_length) {
+        std::vector<Index_> secondary(block_length);
+        std::iota(secondary.begin(), secondary.end(), block_start);
+        return secondary;
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > dense_full(bool row, tatami::MaybeOracle<oracle_, Index_> oracle, const tatami::Options& opt) const {
+        return dense_internal<oracle_>(row, my_matrix->dense(row, opt), std::move(oracle), full_secondary(row));
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > dense_block(bool row, tatami::MaybeOracle<oracle_, Index_> oracle, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return dense_internal<oracle_>(row, my_matrix->dense(row, block_start, block_length, opt), std::move(oracle), block_secondary(block_start, block_length));
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > dense_index(bool row, tatami::MaybeOracle<oracle_, Index_> oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        std::vector<Index_> secondary(indices_ptr->begin(), indices_ptr->end());
+        return dense_internal<oracle_>(row, my_matrix->dense(row, std::move(indices_ptr), opt), std::move(oracle), std::move(secondary));
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, const tatami::Options& opt) const {
+        return dense_full<false>(row, false, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return dense_block<false>(row, false, block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return dense_index<false>(row, false, std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, const tatami::Options& opt) const {
+        return std::make_unique<tatami::FullSparsifiedWrapper<false, Value_, Index_> >(dense(row, opt), (row ? ncol() : nrow()), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return std::make_unique<tatami::BlockSparsifiedWrapper<false, Value_, Index_> >(dense(row, block_start, block_length, opt), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        auto ext = dense(row, indices_ptr, opt);
+        return std::make_unique<tatami::IndexSparsifiedWrapper<false, Value_, Index_> >(std::move(ext), std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return dense_full<true>(row, std::move(oracle), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return dense_block<true>(row, std::move(oracle), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return dense_index<true>(row, std::move(oracle), std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return std::make_unique<tatami::FullSparsifiedWrapper<true, Value_, Index_> >(dense(row, std::move(oracle), opt), (row ? ncol() : nrow()), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return std::make_unique<tatami::BlockSparsifiedWrapper<true, Value_, Index_> >(dense(row, std::move(oracle), block_start, block_length, opt), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        auto ext = dense(row, std::move(oracle), indices_ptr, opt);
+        return std::make_unique<tatami::IndexSparsifiedWrapper<true, Value_, Index_> >(std::move(ext), std::move(indices_ptr), opt);
+    }
+};
+
+#endif
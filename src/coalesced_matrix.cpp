@@ -0,0 +1,16 @@
+#include "coalesced_matrix.h"
+
+#include <atomic>
+#include <thread>
+
+static std::atomic<bool> coalescing_enabled = false;
+
+bool executor_coalescing() {
+    return coalescing_enabled.load(std::memory_order_relaxed);
+}
+
+//[[Rcpp::export(rng=false)]]
+Rcpp::LogicalVector set_executor_coalescing(bool enabled) {
+    bool old = coalescing_enabled.exchange(enabled, std::memory_order_relaxed);
+    return Rcpp::LogicalVector::create(old);
+}
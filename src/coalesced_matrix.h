@@ -0,0 +1,355 @@
+#ifndef BEACHMAT_COALESCED_MATRIX_H
+#define BEACHMAT_COALESCED_MATRIX_H
+
+#include "Rtatami.h"
+#include "executor_profile.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+bool executor_coalescing();
+
+/**
+ * Shared cache of dense chunks along one dimension of an R-backed matrix.
+ * Each chunk contains a contiguous range of rows (or columns) and spans the full extent of the other dimension.
+ *
+ * Worker threads request chunks by calling `fetch()`.
+ * If a chunk is not yet available, it is added to a pending list;
+ * one of the waiting threads then takes all pending chunks and realizes them with a single call to `DelayedArray::extract_array()` on the main thread.
+ * This avoids paying the R call overhead separately for each worker when many workers are waiting on the main thread at once.
+ * Multiple requests for the same chunk are only ever realized once.
+ */
+class CoalescedCache {
+public:
+    CoalescedCache(Rcpp::RObject seed, Rcpp::Function extractor, bool row, int primary, int secondary, int chunk_size, std::size_t max_chunks) :
+        my_seed(std::move(seed)),
+        my_extractor(std::move(extractor)),
+        my_row(row),
+        my_primary(primary),
+        my_secondary(secondary),
+        my_chunk_size(chunk_size),
+        my_max_chunks(max_chunks)
+    {}
+
+    struct Chunk {
+        int start = 0, length = 0;
+        bool ready = false;
+        std::string error;
+        std::vector<double> values;
+    };
+
+    int secondary() const {
+        return my_secondary;
+    }
+
+    std::shared_ptr<const Chunk> fetch(int i) {
+        int id = i / my_chunk_size;
+        std::unique_lock<std::mutex> lck(my_lock);
+
+        std::shared_ptr<Chunk> chunk;
+        auto it = my_chunks.find(id);
+        if (it != my_chunks.end()) {
+            chunk = it->second;
+        } else {
+            chunk = std::make_shared<Chunk>();
+            chunk->start = id * my_chunk_size;
+            chunk->length = std::min(my_chunk_size, my_primary - chunk->start);
+            my_chunks[id] = chunk;
+            my_order.push_back(id);
+            my_pending.push_back(chunk);
+            evict();
+        }
+
+        // If our chunk isn't ready and no one else is talking to the main thread, we do it ourselves.
+        // Otherwise, we wait for the current leader to finish, at which point our chunk is either ready or we become the next leader.
+        while (!chunk->ready) {
+            if (my_leading) {
+                my_cv.wait(lck, [&]() -> bool { return chunk->ready || !my_leading; });
+            } else {
+                lead(lck);
+            }
+        }
+
+        if (!chunk->error.empty()) {
+            throw std::runtime_error(chunk->error);
+        }
+        return chunk;
+    }
+
+private:
+    Rcpp::RObject my_seed;
+    Rcpp::Function my_extractor;
+    bool my_row;
+    int my_primary, my_secondary, my_chunk_size;
+    std::size_t my_max_chunks;
+
+    std::mutex my_lock;
+    std::condition_variable my_cv;
+    bool my_leading = false;
+    std::unordered_map<int, std::shared_ptr<Chunk> > my_chunks;
+    std::deque<int> my_order;
+    std::vector<std::shared_ptr<Chunk> > my_pending;
+
+    void evict() {
+        // Only evicting chunks that are ready; in-flight chunks are still referenced by their waiting threads.
+        // Evicted chunks remain alive in any extractor that is still holding them.
+        auto nattempts = my_order.size();
+        for (decltype(nattempts) a = 0; a < nattempts && my_chunks.size() > my_max_chunks; ++a) {
+            int id = my_order.front();
+            my_order.pop_front();
+            auto it = my_chunks.find(id);
+            if (it == my_chunks.end()) {
+                continue;
+            }
+            if (it->second->ready) {
+                my_chunks.erase(it);
+            } else {
+                my_order.push_back(id);
+            }
+        }
+    }
+
+    void lead(std::unique_lock<std::mutex>& lck) {
+        my_leading = true;
+        std::vector<std::shared_ptr<Chunk> > batch;
+        batch.swap(my_pending);
+        lck.unlock();
+
+        std::string error;
+        try {
+            realize(batch);
+        } catch (std::exception& e) {
+            error = e.what();
+            if (error.empty()) {
+                error = "failed to extract a block from an R-backed matrix";
+            }
+        }
+
+        lck.lock();
+        for (auto& chunk : batch) {
+            chunk->ready = true;
+            if (!error.empty()) {
+                chunk->error = error;
+                int id = chunk->start / my_chunk_size;
+                auto it = my_chunks.find(id);
+                if (it != my_chunks.end() && it->second == chunk) {
+                    my_chunks.erase(it); // allow a later retry.
+
+                    // Also removing the ID from the eviction order, otherwise a retry would add a duplicate entry
+                    // and the stale entry would cause the retried chunk to be evicted too early.
+                    auto oIt = std::find(my_order.begin(), my_order.end(), id);
+                    if (oIt != my_order.end()) {
+                        my_order.erase(oIt);
+                    }
+                }
+            }
+        }
+        my_leading = false;
+        my_cv.notify_all();
+    }
+
+    void realize(std::vector<std::shared_ptr<Chunk> >& batch) {
+        if (batch.empty()) {
+            return;
+        }
+
+        // Sorting so that adjacent chunks form a contiguous range in the combined block.
+        std::sort(batch.begin(), batch.end(), [](const std::shared_ptr<Chunk>& left, const std::shared_ptr<Chunk>& right) -> bool { return left->start < right->start; });
+        std::size_t total = 0;
+        for (const auto& chunk : batch) {
+            total += chunk->length;
+            chunk->values.resize(static_cast<std::size_t>(chunk->length) * static_cast<std::size_t>(my_secondary));
+        }
+
+        profiled_run([&]() -> void {
+            Rcpp::IntegerVector indices(total);
+            auto iIt = indices.begin();
+            for (const auto& chunk : batch) {
+                for (int p = 0; p < chunk->length; ++p, ++iIt) {
+                    *iIt = chunk->start + p + 1; // 1-based.
+                }
+            }
+
+            Rcpp::List args(2);
+            args[my_row ? 0 : 1] = indices;
+            Rcpp::NumericVector block(my_extractor(my_seed, args)); // coerces integer/logical values to double.
+
+            // The block is column-major with 'total' rows (if my_row = true) or 'total' columns (otherwise).
+            // Row chunks are stored in row-major format so that each row is contiguous, while column chunks are just a contiguous slice of the block.
+            const double* bptr = static_cast<const double*>(block.begin());
+            std::size_t offset = 0;
+            for (auto& chunk : batch) {
+                if (my_row) {
+                    for (int p = 0; p < chunk->length; ++p) {
+                        auto out = chunk->values.data() + static_cast<std::size_t>(p) * static_cast<std::size_t>(my_secondary);
+                        auto in = bptr + offset + p;
+                        for (int s = 0; s < my_secondary; ++s, in += total) {
+                            out[s] = *in;
+                        }
+                    }
+                } else {
+                    auto in = bptr + offset * static_cast<std::size_t>(my_secondary);
+                    std::copy_n(in, chunk->values.size(), chunk->values.data());
+                }
+                offset += chunk->length;
+            }
+        });
+    }
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class CoalescedDenseExtractor final : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+public:
+    CoalescedDenseExtractor(std::shared_ptr<CoalescedCache> cache, tatami::MaybeOracle<oracle_, Index_> oracle) :
+        my_cache(std::move(cache)), my_oracle(std::move(oracle)), my_block_start(0), my_block_length(my_cache->secondary()) {}
+
+    CoalescedDenseExtractor(std::shared_ptr<CoalescedCache> cache, tatami::MaybeOracle<oracle_, Index_> oracle, Index_ block_start, Index_ block_length) :
+        my_cache(std::move(cache)), my_oracle(std::move(oracle)), my_block_start(block_start), my_block_length(block_length) {}
+
+    CoalescedDenseExtractor(std::shared_ptr<CoalescedCache> cache, tatami::MaybeOracle<oracle_, Index_> oracle, tatami::VectorPtr<Index_> indices_ptr) :
+        my_cache(std::move(cache)), my_oracle(std::move(oracle)), my_block_start(0), my_block_length(0), my_indices(std::move(indices_ptr)) {}
+
+    const Value_* fetch(Index_ i, Value_* buffer) {
+        if constexpr(oracle_) {
+            i = my_oracle->get(my_used);
+            ++my_used;
+        }
+
+        if (!my_chunk || i < my_chunk->start || i >= my_chunk->start + my_chunk->length) {
+            my_chunk = my_cache->fetch(i);
+        }
+        const double* src = my_chunk->values.data() + static_cast<std::size_t>(i - my_chunk->start) * static_cast<std::size_t>(my_cache->secondary());
+
+        if (my_indices) {
+            const auto& indices = *my_indices;
+            std::size_t n = indices.size();
+            for (std::size_t x = 0; x < n; ++x) {
+                buffer[x] = src[indices[x]];
+            }
+        } else {
+            std::copy_n(src + my_block_start, my_block_length, buffer);
+        }
+        return buffer;
+    }
+
+private:
+    std::shared_ptr<CoalescedCache> my_cache;
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    typename std::conditional<oracle_, std::size_t, bool>::type my_used = 0;
+    Index_ my_block_start, my_block_length;
+    tatami::VectorPtr<Index_> my_indices;
+    std::shared_ptr<const CoalescedCache::Chunk> my_chunk;
+};
+
+/**
+ * Wraps a dense R-backed matrix so that concurrent dense extraction requests from worker threads are coalesced into a single R call.
+ * Sparse extraction is passed through to the wrapped matrix.
+ */
+template<typename Value_, typename Index_>
+class CoalescedMatrix final : public tatami::Matrix<Value_, Index_> {
+public:
+    CoalescedMatrix(std::shared_ptr<const tatami::Matrix<Value_, Index_> > matrix, std::shared_ptr<CoalescedCache> row_cache, std::shared_ptr<CoalescedCache> column_cache) :
+        my_matrix(std::move(matrix)), my_row_cache(std::move(row_cache)), my_column_cache(std::move(column_cache)) {}
+
+private:
+    std::shared_ptr<const tatami::Matrix<Value_, Index_> > my_matrix;
+    std::shared_ptr<CoalescedCache> my_row_cache, my_column_cache;
+
+public:
+    Index_ nrow() const {
+        return my_matrix->nrow();
+    }
+
+    Index_ ncol() const {
+        return my_matrix->ncol();
+    }
+
+    bool is_sparse() const {
+        return my_matrix->is_sparse();
+    }
+
+    double is_sparse_proportion() const {
+        return my_matrix->is_sparse_proportion();
+    }
+
+    bool prefer_rows() const {
+        return my_matrix->prefer_rows();
+    }
+
+    double prefer_rows_proportion() const {
+        return my_matrix->prefer_rows_proportion();
+    }
+
+    bool uses_oracle(bool row) const {
+        return my_matrix->uses_oracle(row);
+    }
+
+    using tatami::Matrix<Value_, Index_>::dense;
+
+    using tatami::Matrix<Value_, Index_>::sparse;
+
+private:
+    template<bool oracle_, typename ... Args_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > dense_internal(bool row, tatami::MaybeOracle<oracle_, Index_> oracle, Args_&& ... args) const {
+        return std::make_unique<CoalescedDenseExtractor<oracle_, Value_, Index_> >(row ? my_row_cache : my_column_cache, std::move(oracle), std::forward<Args_>(args)...);
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, const tatami::Options&) const {
+        return dense_internal<false>(row, false);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, Index_ block_start, Index_ block_length, const tatami::Options&) const {
+        return dense_internal<false>(row, false, block_start, block_length);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options&) const {
+        return dense_internal<false>(row, false, std::move(indices_ptr));
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, const tatami::Options& opt) const {
+        return my_matrix->sparse(row, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return my_matrix->sparse(row, block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return my_matrix->sparse(row, std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options&) const {
+        return dense_internal<true>(row, std::move(oracle));
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options&) const {
+        return dense_internal<true>(row, std::move(oracle), block_start, block_length);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options&) const {
+        return dense_internal<true>(row, std::move(oracle), std::move(indices_ptr));
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return my_matrix->sparse(row, std::move(oracle), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return my_matrix->sparse(row, std::move(oracle), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return my_matrix->sparse(row, std::move(oracle), std::move(indices_ptr), opt);
+    }
+};
+
+#endif
@@ -1,8 +1,11 @@
 #include "Rtatami.h"
 
+#include "node_info.h"
+
 //[[Rcpp::export(rng=false)]]
 SEXP initialize_constant_matrix(int nrow, int ncol, double val) {
     auto output = Rtatami::new_BoundNumericMatrix();
     output->ptr.reset(new tatami::ConstantMatrix(nrow, ncol, val));
+    annotate_node(output, "initialize_constant_matrix", Rcpp::List(), Rcpp::List::create(Rcpp::Named("nrow") = nrow, Rcpp::Named("ncol") = ncol, Rcpp::Named("val") = val));
     return output;
 }
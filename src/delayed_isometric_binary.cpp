@@ -6,6 +6,8 @@
 #include <string>
 #include <stdexcept>
 
+#include "node_info.h"
+
 //[[Rcpp::export(rng=false)]]
 SEXP apply_delayed_binary_operation(SEXP left_input, SEXP right_input, std::string op) {
     Rtatami::BoundNumericPointer left(left_input);
@@ -54,5 +56,6 @@ SEXP apply_delayed_binary_operation(SEXP left_input, SEXP right_input, std::stri
     auto output = Rtatami::new_BoundNumericMatrix();
     output->ptr.reset(new tatami::DelayedBinaryIsometricOperation<double, double, int>(left_shared, right_shared, std::move(opptr)));
     output->original = protectorate; // propagate protection for all child objects by copying references.
+    annotate_node(output, "apply_delayed_binary_operation", Rcpp::List::create(left_input, right_input), Rcpp::List::create(Rcpp::Named("op") = op));
     return output;
 }
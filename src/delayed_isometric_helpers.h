@@ -0,0 +1,195 @@
+#ifndef BEACHMAT_DELAYED_ISOMETRIC_HELPERS_H
+#define BEACHMAT_DELAYED_ISOMETRIC_HELPERS_H
+
+#include "Rtatami.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+/**
+ * Helpers for unary operations that are not provided by tatami itself.
+ * These mimic the corresponding R functions, including their treatment of NA and NaN values.
+ */
+
+/**
+ * Applies a pure element-wise function.
+ * The result is sparse if the function maps zero to zero.
+ */
+template<class Function_>
+class DelayedUnaryIsometricElementwiseHelper final : public tatami::DelayedUnaryIsometricOperationHelper<double, double, int> {
+public:
+    DelayedUnaryIsometricElementwiseHelper(Function_ fun) : my_fun(std::move(fun)) {
+        my_fill = my_fun(0);
+        my_sparse = (my_fill == 0);
+    }
+
+private:
+    Function_ my_fun;
+    double my_fill;
+    bool my_sparse;
+
+public:
+    bool zero_depends_on_row() const {
+        return false;
+    }
+
+    bool zero_depends_on_column() const {
+        return false;
+    }
+
+    bool non_zero_depends_on_row() const {
+        return false;
+    }
+
+    bool non_zero_depends_on_column() const {
+        return false;
+    }
+
+public:
+    void dense(bool, int, int, int length, const double* input, double* output) const {
+        for (int j = 0; j < length; ++j) {
+            output[j] = my_fun(input[j]);
+        }
+    }
+
+    void dense(bool, int, const std::vector<int>& indices, const double* input, double* output) const {
+        int length = indices.size();
+        for (int j = 0; j < length; ++j) {
+            output[j] = my_fun(input[j]);
+        }
+    }
+
+public:
+    bool is_sparse() const {
+        return my_sparse;
+    }
+
+    void sparse(bool, int, int number, const double* input_value, const int*, double* output_value) const {
+        for (int j = 0; j < number; ++j) {
+            output_value[j] = my_fun(input_value[j]);
+        }
+    }
+
+    double fill(bool, int) const {
+        return my_fill;
+    }
+};
+
+template<class Function_>
+std::shared_ptr<tatami::DelayedUnaryIsometricOperationHelper<double, double, int> > make_elementwise_helper(Function_ fun) {
+    return std::make_shared<DelayedUnaryIsometricElementwiseHelper<Function_> >(std::move(fun));
+}
+
+/**
+ * Element-wise minimum or maximum with a scalar, i.e., pmin() or pmax().
+ * As in R, an NA or NaN in either argument is propagated to the result.
+ */
+template<bool maximum_>
+double clamp_value(double x, double val) {
+    if (std::isnan(x)) {
+        return x;
+    } else if (std::isnan(val)) {
+        return val;
+    } else if constexpr(maximum_) {
+        return (x < val ? val : x);
+    } else {
+        return (x > val ? val : x);
+    }
+}
+
+/**
+ * Element-wise minimum or maximum with a vector along the rows or columns.
+ * The result is sparse if all elements of the vector are non-negative (for the minimum) or non-positive (for the maximum).
+ */
+template<bool maximum_, class Vector_>
+class DelayedUnaryIsometricClampVectorHelper final : public tatami::DelayedUnaryIsometricOperationHelper<double, double, int> {
+public:
+    DelayedUnaryIsometricClampVectorHelper(Vector_ vector, bool by_row) : my_vector(std::move(vector)), my_by_row(by_row) {
+        my_sparse = true;
+        for (auto v : my_vector) {
+            if (clamp_value<maximum_>(0, v) != 0) {
+                my_sparse = false;
+                break;
+            }
+        }
+    }
+
+private:
+    Vector_ my_vector;
+    bool my_by_row;
+    bool my_sparse;
+
+public:
+    bool zero_depends_on_row() const {
+        return my_by_row;
+    }
+
+    bool zero_depends_on_column() const {
+        return !my_by_row;
+    }
+
+    bool non_zero_depends_on_row() const {
+        return my_by_row;
+    }
+
+    bool non_zero_depends_on_column() const {
+        return !my_by_row;
+    }
+
+public:
+    void dense(bool row, int idx, int start, int length, const double* input, double* output) const {
+        if (row == my_by_row) {
+            double val = my_vector[idx];
+            for (int j = 0; j < length; ++j) {
+                output[j] = clamp_value<maximum_>(input[j], val);
+            }
+        } else {
+            for (int j = 0; j < length; ++j) {
+                output[j] = clamp_value<maximum_>(input[j], my_vector[start + j]);
+            }
+        }
+    }
+
+    void dense(bool row, int idx, const std::vector<int>& indices, const double* input, double* output) const {
+        int length = indices.size();
+        if (row == my_by_row) {
+            double val = my_vector[idx];
+            for (int j = 0; j < length; ++j) {
+                output[j] = clamp_value<maximum_>(input[j], val);
+            }
+        } else {
+            for (int j = 0; j < length; ++j) {
+                output[j] = clamp_value<maximum_>(input[j], my_vector[indices[j]]);
+            }
+        }
+    }
+
+public:
+    bool is_sparse() const {
+        return my_sparse;
+    }
+
+    void sparse(bool row, int idx, int number, const double* input_value, const int* indices, double* output_value) const {
+        if (row == my_by_row) {
+            double val = my_vector[idx];
+            for (int j = 0; j < number; ++j) {
+                output_value[j] = clamp_value<maximum_>(input_value[j], val);
+            }
+        } else {
+            for (int j = 0; j < number; ++j) {
+                output_value[j] = clamp_value<maximum_>(input_value[j], my_vector[indices[j]]);
+            }
+        }
+    }
+
+    double fill(bool row, int idx) const {
+        if (row == my_by_row) {
+            return clamp_value<maximum_>(0, my_vector[idx]);
+        } else {
+            return 0; // zero depends on the other dimension, so this should only be called if the result is sparse.
+        }
+    }
+};
+
+#endif
@@ -3,10 +3,14 @@
 #include "tatami/tatami.hpp"
 #include "Rmath.h"
 
+#include <cmath>
 #include <memory>
 #include <string>
 #include <stdexcept>
 
+#include "node_info.h"
+#include "delayed_isometric_helpers.h"
+
 //[[Rcpp::export(rng=false)]]
 SEXP apply_delayed_log(SEXP raw_input, double base) {
     Rtatami::BoundNumericPointer input(raw_input);
@@ -19,6 +23,7 @@ SEXP apply_delayed_log(SEXP raw_input, double base) {
         output->ptr.reset(new tatami::DelayedUnaryIsometricOperation<double, double, int>(input->ptr, std::make_shared<tatami::DelayedUnaryIsometricCustomLogHelper<double, double, int, double> >(base)));
     }
     output->original = input->original; // copying the reference to propagate GC protection.
+    annotate_node(output, "apply_delayed_log", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("base") = base));
     return output;
 }
 
@@ -94,14 +99,61 @@ SEXP apply_delayed_unary_math(SEXP raw_input, const std::string& op) {
     auto output = Rtatami::new_BoundNumericMatrix();
     output->ptr.reset(new tatami::DelayedUnaryIsometricOperation<double, double, int>(std::move(iptr), std::move(opptr)));
     output->original = input->original; // copying the reference to propagate GC protection.
+    annotate_node(output, "apply_delayed_unary_math", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("op") = op));
+    return output;
+}
+
+//[[Rcpp::export(rng=false)]]
+SEXP apply_delayed_round(SEXP raw_input, double digits = 0) {
+    Rtatami::BoundNumericPointer input(raw_input);
+    std::shared_ptr<tatami::DelayedUnaryIsometricOperationHelper<double, double, int> > opptr;
+    if (digits == 0) {
+        opptr.reset(new tatami::DelayedUnaryIsometricRoundHelper<double, double, int>());
+    } else {
+        opptr = make_elementwise_helper([digits](double x) -> double { return fround(x, digits); });
+    }
+
+    auto output = Rtatami::new_BoundNumericMatrix();
+    output->ptr.reset(new tatami::DelayedUnaryIsometricOperation<double, double, int>(input->ptr, std::move(opptr)));
+    output->original = input->original; // copying the reference to propagate GC protection.
+    annotate_node(output, "apply_delayed_round", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("digits") = digits));
     return output;
 }
 
 //[[Rcpp::export(rng=false)]]
-SEXP apply_delayed_round(SEXP raw_input) {
+SEXP apply_delayed_signif(SEXP raw_input, double digits) {
     Rtatami::BoundNumericPointer input(raw_input);
     auto output = Rtatami::new_BoundNumericMatrix();
-    output->ptr.reset(new tatami::DelayedUnaryIsometricOperation<double, double, int>(input->ptr, std::make_shared<tatami::DelayedUnaryIsometricRoundHelper<double, double, int> >()));
+    output->ptr.reset(new tatami::DelayedUnaryIsometricOperation<double, double, int>(
+        input->ptr,
+        make_elementwise_helper([digits](double x) -> double { return fprec(x, digits); })
+    ));
+    output->original = input->original; // copying the reference to propagate GC protection.
+    annotate_node(output, "apply_delayed_signif", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("digits") = digits));
+    return output;
+}
+
+//[[Rcpp::export(rng=false)]]
+SEXP apply_delayed_special_check(SEXP raw_input, const std::string& op) {
+    Rtatami::BoundNumericPointer input(raw_input);
+
+    // is.na() and is.nan() are both sparse, as zero is neither NA nor NaN; is.finite() is the only one that is not.
+    std::shared_ptr<tatami::DelayedUnaryIsometricOperationHelper<double, double, int> > opptr;
+    if (op == "is.na") {
+        opptr = make_elementwise_helper([](double x) -> double { return std::isnan(x); });
+    } else if (op == "is.nan") {
+        opptr = make_elementwise_helper([](double x) -> double { return std::isnan(x) && !R_IsNA(x); });
+    } else if (op == "is.finite") {
+        opptr = make_elementwise_helper([](double x) -> double { return std::isfinite(x); });
+    } else if (op == "is.infinite") {
+        opptr = make_elementwise_helper([](double x) -> double { return std::isinf(x); });
+    } else {
+        throw std::runtime_error("unknown special check '" + op + "'");
+    }
+
+    auto output = Rtatami::new_BoundNumericMatrix();
+    output->ptr.reset(new tatami::DelayedUnaryIsometricOperation<double, double, int>(input->ptr, std::move(opptr)));
     output->original = input->original; // copying the reference to propagate GC protection.
+    annotate_node(output, "apply_delayed_special_check", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("op") = op));
     return output;
 }
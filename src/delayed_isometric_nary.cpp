@@ -0,0 +1,89 @@
+#include "Rtatami.h"
+#include "Rcpp.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "node_info.h"
+#include "delayed_isometric_nary.h"
+
+template<class Operation_>
+static std::shared_ptr<tatami::Matrix<double, int> > create_nary(std::vector<std::shared_ptr<const tatami::Matrix<double, int> > > operands, std::vector<std::vector<double> > extras, Operation_ op) {
+    return std::make_shared<DelayedNaryIsometricOperation<Operation_, double, int> >(std::move(operands), std::move(extras), std::move(op));
+}
+
+//[[Rcpp::export(rng=false)]]
+SEXP apply_delayed_nary_operation(Rcpp::List input, std::string op, Rcpp::List extras, bool na_rm) {
+    if (input.size() == 0) {
+        throw std::runtime_error("expected at least one operand for a delayed n-ary operation");
+    }
+
+    std::vector<std::shared_ptr<const tatami::Matrix<double, int> > > operands;
+    operands.reserve(input.size());
+    Rcpp::List protectorate(input.size());
+
+    for (decltype(input.size()) i = 0, end = input.size(); i < end; ++i) {
+        Rcpp::RObject current = input[i];
+        Rtatami::BoundNumericPointer curptr(current);
+        protectorate[i] = curptr->original;
+        const auto& shared = curptr->ptr;
+        if (i && (shared->nrow() != operands.front()->nrow() || shared->ncol() != operands.front()->ncol())) {
+            throw std::runtime_error("all operands of a delayed n-ary operation should have the same dimensions");
+        }
+        operands.push_back(shared);
+    }
+
+    // Copying the extra arguments, as these are usually small.
+    std::vector<std::vector<double> > extra_values;
+    extra_values.reserve(extras.size());
+    for (decltype(extras.size()) e = 0, end = extras.size(); e < end; ++e) {
+        Rcpp::NumericVector current(extras[e]);
+        if (current.size() == 0) {
+            throw std::runtime_error("additional arguments for a delayed n-ary operation should be non-empty");
+        }
+        extra_values.emplace_back(current.begin(), current.end());
+    }
+
+    std::shared_ptr<tatami::Matrix<double, int> > ptr;
+    if (op == "+") {
+        ptr = create_nary(std::move(operands), std::move(extra_values), NaryAddOperation());
+    } else if (op == "-") {
+        ptr = create_nary(std::move(operands), std::move(extra_values), NarySubtractOperation());
+    } else if (op == "*") {
+        ptr = create_nary(std::move(operands), std::move(extra_values), NaryMultiplyOperation());
+    } else if (op == "/") {
+        ptr = create_nary(std::move(operands), std::move(extra_values), NaryDivideOperation());
+    } else if (op == "^") {
+        ptr = create_nary(std::move(operands), std::move(extra_values), NaryPowerOperation());
+    } else if (op == "%%") {
+        ptr = create_nary(std::move(operands), std::move(extra_values), NaryModuloOperation());
+    } else if (op == "%/%") {
+        ptr = create_nary(std::move(operands), std::move(extra_values), NaryIntegerDivideOperation());
+    } else if (op == "&") {
+        ptr = create_nary(std::move(operands), std::move(extra_values), NaryAndOperation());
+    } else if (op == "|") {
+        ptr = create_nary(std::move(operands), std::move(extra_values), NaryOrOperation());
+    } else if (op == "pmin") {
+        if (na_rm) {
+            ptr = create_nary(std::move(operands), std::move(extra_values), NaryClampOperation<false, true>());
+        } else {
+            ptr = create_nary(std::move(operands), std::move(extra_values), NaryClampOperation<false, false>());
+        }
+    } else if (op == "pmax") {
+        if (na_rm) {
+            ptr = create_nary(std::move(operands), std::move(extra_values), NaryClampOperation<true, true>());
+        } else {
+            ptr = create_nary(std::move(operands), std::move(extra_values), NaryClampOperation<true, false>());
+        }
+    } else {
+        throw std::runtime_error("unknown delayed n-ary operation '" + op + "'");
+    }
+
+    auto output = Rtatami::new_BoundNumericMatrix();
+    output->ptr = std::move(ptr);
+    output->original = protectorate; // propagate protection for all child objects by copying references.
+    annotate_node(output, "apply_delayed_nary_operation", input, Rcpp::List::create(Rcpp::Named("op") = op, Rcpp::Named("extras") = extras, Rcpp::Named("na_rm") = na_rm));
+    return output;
+}
@@ -0,0 +1,522 @@
+#ifndef BEACHMAT_DELAYED_ISOMETRIC_NARY_H
+#define BEACHMAT_DELAYED_ISOMETRIC_NARY_H
+
+#include "Rtatami.h"
+#include "delayed_isometric_helpers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+/**
+ * Element-wise operations for the n-ary node.
+ * Each operation combines the accumulated value with the value from the next operand,
+ * so the node computes 'op(op(op(a, b), c), ...)' in the same manner as nested binary operations.
+ */
+struct NaryAddOperation {
+    double operator()(double x, double y) const {
+        return x + y;
+    }
+};
+
+struct NarySubtractOperation {
+    double operator()(double x, double y) const {
+        return x - y;
+    }
+};
+
+struct NaryMultiplyOperation {
+    double operator()(double x, double y) const {
+        return x * y;
+    }
+};
+
+struct NaryDivideOperation {
+    double operator()(double x, double y) const {
+        return x / y;
+    }
+};
+
+struct NaryPowerOperation {
+    double operator()(double x, double y) const {
+        return std::pow(x, y);
+    }
+};
+
+// Mimicking R's myfmod() and myfloor() in arithmetic.c.
+struct NaryModuloOperation {
+    double operator()(double x, double y) const {
+        if (y == 0) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        double tmp = x - std::floor(x / y) * y;
+        return tmp - std::floor(tmp / y) * y;
+    }
+};
+
+struct NaryIntegerDivideOperation {
+    double operator()(double x, double y) const {
+        if (y == 0) {
+            return x / y;
+        }
+        double q = std::floor(x / y);
+        double tmp = x - q * y;
+        return q + std::floor(tmp / y);
+    }
+};
+
+// Using R's three-valued logic, where NA & FALSE is FALSE and NA | TRUE is TRUE.
+struct NaryAndOperation {
+    double operator()(double x, double y) const {
+        if (x == 0 || y == 0) {
+            return 0;
+        } else if (std::isnan(x) || std::isnan(y)) {
+            return NA_REAL;
+        } else {
+            return 1;
+        }
+    }
+};
+
+struct NaryOrOperation {
+    double operator()(double x, double y) const {
+        if ((x != 0 && !std::isnan(x)) || (y != 0 && !std::isnan(y))) {
+            return 1;
+        } else if (std::isnan(x) || std::isnan(y)) {
+            return NA_REAL;
+        } else {
+            return 0;
+        }
+    }
+};
+
+template<bool maximum_, bool na_rm_>
+struct NaryClampOperation {
+    double operator()(double x, double y) const {
+        if constexpr(na_rm_) {
+            if (std::isnan(x)) {
+                return y;
+            } else if (std::isnan(y)) {
+                return x;
+            }
+        }
+        return clamp_value<maximum_>(x, y);
+    }
+};
+
+/**
+ * Additional vectors that are recycled across the matrix in column-major order, like the extra arguments to pmin() or pmax().
+ * These are applied after all of the matrix operands.
+ */
+template<typename Value_, typename Index_>
+struct NaryExtras {
+    NaryExtras(std::vector<std::vector<Value_> > values, Index_ nrow) : values(std::move(values)), nrow(nrow) {
+        for (const auto& v : this->values) {
+            if (v.size() > 1) {
+                recycled = true;
+            }
+        }
+    }
+
+    std::vector<std::vector<Value_> > values;
+    Index_ nrow;
+    bool recycled = false;
+
+    std::size_t position(bool row, Index_ i, Index_ s) const {
+        if (row) {
+            return static_cast<std::size_t>(s) * nrow + i;
+        } else {
+            return static_cast<std::size_t>(i) * nrow + s;
+        }
+    }
+
+    template<class Operation_>
+    Value_ apply(const Operation_& op, Value_ current, bool row, Index_ i, Index_ s) const {
+        for (const auto& v : values) {
+            current = op(current, v.size() == 1 ? v[0] : v[position(row, i, s) % v.size()]);
+        }
+        return current;
+    }
+};
+
+/**
+ * Extracts each operand once and combines them in a single pass over the dense output.
+ */
+template<bool oracle_, class Operation_, typename Value_, typename Index_>
+class NaryDenseExtractor final : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+public:
+    NaryDenseExtractor(
+        const Operation_* op,
+        const NaryExtras<Value_, Index_>* extras,
+        std::vector<std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > > children,
+        tatami::MaybeOracle<oracle_, Index_> oracle,
+        bool row,
+        Index_ extent,
+        std::vector<Index_> secondary) :
+        my_op(op),
+        my_extras(extras),
+        my_children(std::move(children)),
+        my_oracle(std::move(oracle)),
+        my_row(row),
+        my_extent(extent),
+        my_secondary(std::move(secondary)),
+        my_holding(extent)
+    {}
+
+    const Value_* fetch(Index_ i, Value_* buffer) {
+        if constexpr(oracle_) {
+            i = my_oracle->get(my_used);
+            ++my_used;
+        }
+
+        auto first = my_children.front()->fetch(i, buffer);
+        tatami::copy_n(first, my_extent, buffer);
+
+        for (std::size_t c = 1, nchildren = my_children.size(); c < nchildren; ++c) {
+            auto ptr = my_children[c]->fetch(i, my_holding.data());
+            for (Index_ j = 0; j < my_extent; ++j) {
+                buffer[j] = (*my_op)(buffer[j], ptr[j]);
+            }
+        }
+
+        for (const auto& v : my_extras->values) {
+            if (v.size() == 1) {
+                for (Index_ j = 0; j < my_extent; ++j) {
+                    buffer[j] = (*my_op)(buffer[j], v[0]);
+                }
+            } else {
+                for (Index_ j = 0; j < my_extent; ++j) {
+                    buffer[j] = (*my_op)(buffer[j], v[my_extras->position(my_row, i, my_secondary[j]) % v.size()]);
+                }
+            }
+        }
+
+        return buffer;
+    }
+
+private:
+    const Operation_* my_op;
+    const NaryExtras<Value_, Index_>* my_extras;
+    std::vector<std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > > my_children;
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    typename std::conditional<oracle_, std::size_t, bool>::type my_used = 0;
+    bool my_row;
+    Index_ my_extent;
+    std::vector<Index_> my_secondary; // only filled if the extras need to be recycled.
+    std::vector<Value_> my_holding;
+};
+
+/**
+ * Extracts each sparse operand once and merges the union of their non-zero indices.
+ * This is only used if the operation maps zeros in all operands (and the extras) to zero.
+ */
+template<bool oracle_, class Operation_, typename Value_, typename Index_>
+class NarySparseExtractor final : public tatami::SparseExtractor<oracle_, Value_, Index_> {
+public:
+    NarySparseExtractor(
+        const Operation_* op,
+        const NaryExtras<Value_, Index_>* extras,
+        std::vector<std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > > children,
+        tatami::MaybeOracle<oracle_, Index_> oracle,
+        bool row,
+        Index_ extent,
+        const tatami::Options& opt) :
+        my_op(op),
+        my_extras(extras),
+        my_children(std::move(children)),
+        my_oracle(std::move(oracle)),
+        my_row(row),
+        my_extract_value(opt.sparse_extract_value),
+        my_extract_index(opt.sparse_extract_index),
+        my_ranges(my_children.size()),
+        my_positions(my_children.size()),
+        my_value_holding(my_children.size()),
+        my_index_holding(my_children.size())
+    {
+        for (std::size_t c = 0, nchildren = my_children.size(); c < nchildren; ++c) {
+            my_value_holding[c].resize(extent);
+            my_index_holding[c].resize(extent);
+        }
+    }
+
+    tatami::SparseRange<Value_, Index_> fetch(Index_ i, Value_* value_buffer, Index_* index_buffer) {
+        if constexpr(oracle_) {
+            i = my_oracle->get(my_used);
+            ++my_used;
+        }
+
+        std::size_t nchildren = my_children.size();
+        for (std::size_t c = 0; c < nchildren; ++c) {
+            my_ranges[c] = my_children[c]->fetch(i, my_value_holding[c].data(), my_index_holding[c].data());
+            my_positions[c] = 0;
+        }
+
+        Index_ count = 0;
+        while (true) {
+            bool found = false;
+            Index_ next = std::numeric_limits<Index_>::max();
+            for (std::size_t c = 0; c < nchildren; ++c) {
+                if (my_positions[c] < my_ranges[c].number) {
+                    next = std::min(next, my_ranges[c].index[my_positions[c]]);
+                    found = true;
+                }
+            }
+            if (!found) {
+                break;
+            }
+
+            Value_ current = 0;
+            for (std::size_t c = 0; c < nchildren; ++c) {
+                Value_ val = 0;
+                auto& pos = my_positions[c];
+                const auto& range = my_ranges[c];
+                if (pos < range.number && range.index[pos] == next) {
+                    val = range.value[pos];
+                    ++pos;
+                }
+                current = (c == 0 ? val : (*my_op)(current, val));
+            }
+
+            if (my_extract_value) {
+                value_buffer[count] = my_extras->apply(*my_op, current, my_row, i, next);
+            }
+            if (my_extract_index) {
+                index_buffer[count] = next;
+            }
+            ++count;
+        }
+
+        return tatami::SparseRange<Value_, Index_>(count, (my_extract_value ? value_buffer : NULL), (my_extract_index ? index_buffer : NULL));
+    }
+
+private:
+    const Operation_* my_op;
+    const NaryExtras<Value_, Index_>* my_extras;
+    std::vector<std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > > my_children;
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    typename std::conditional<oracle_, std::size_t, bool>::type my_used = 0;
+    bool my_row;
+    bool my_extract_value, my_extract_index;
+
+    std::vector<tatami::SparseRange<Value_, Index_> > my_ranges;
+    std::vector<Index_> my_positions;
+    std::vector<std::vector<Value_> > my_value_holding;
+    std::vector<std::vector<Index_> > my_index_holding;
+};
+
+/**
+ * Applies an element-wise operation across any number of operands of the same dimensions.
+ * Unlike nested DelayedBinaryIsometricOperations, each operand is only extracted once per row/column,
+ * and all operands are combined in a single loop.
+ */
+template<class Operation_, typename Value_, typename Index_>
+class DelayedNaryIsometricOperation final : public tatami::Matrix<Value_, Index_> {
+public:
+    DelayedNaryIsometricOperation(std::vector<std::shared_ptr<const tatami::Matrix<Value_, Index_> > > operands, std::vector<std::vector<Value_> > extras, Operation_ op) :
+        my_operands(std::move(operands)), my_op(std::move(op)), my_extras(std::move(extras), my_operands.front()->nrow())
+    {
+        // The output is sparse if all operands are sparse and zeros are preserved at each step.
+        my_sparse = (my_op(0, 0) == 0);
+        for (const auto& v : my_extras.values) {
+            for (auto x : v) {
+                if (my_op(0, x) != 0) {
+                    my_sparse = false;
+                    break;
+                }
+            }
+        }
+        for (const auto& operand : my_operands) {
+            if (!operand->is_sparse()) {
+                my_sparse = false;
+            }
+        }
+    }
+
+private:
+    std::vector<std::shared_ptr<const tatami::Matrix<Value_, Index_> > > my_operands;
+    Operation_ my_op;
+    NaryExtras<Value_, Index_> my_extras;
+    bool my_sparse;
+
+public:
+    Index_ nrow() const {
+        return my_operands.front()->nrow();
+    }
+
+    Index_ ncol() const {
+        return my_operands.front()->ncol();
+    }
+
+    bool is_sparse() const {
+        return my_sparse;
+    }
+
+    double is_sparse_proportion() const {
+        return (my_sparse ? 1 : 0);
+    }
+
+    bool prefer_rows() const {
+        return prefer_rows_proportion() > 0.5;
+    }
+
+    double prefer_rows_proportion() const {
+        double total = 0;
+        for (const auto& operand : my_operands) {
+            total += operand->prefer_rows_proportion();
+        }
+        return total / my_operands.size();
+    }
+
+    bool uses_oracle(bool row) const {
+        for (const auto& operand : my_operands) {
+            if (operand->uses_oracle(row)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    using tatami::Matrix<Value_, Index_>::dense;
+
+    using tatami::Matrix<Value_, Index_>::sparse;
+
+private:
+    std::vector<Index_> full_secondary(bool row) const {
+        std::vector<Index_> secondary;
+        if (my_extras.recycled) {
+            secondary.resize(row ? ncol() : nrow());
+            std::iota(secondary.begin(), secondary.end(), static_cast<Index_>(0));
+        }
+        return secondary;
+    }
+
+    std::vector<Index_> block_secondary(Index_ block_start, Index_ block_length) const {
+        std::vector<Index_> secondary;
+        if (my_extras.recycled) {
+            secondary.resize(block_length);
+            std::iota(secondary.begin(), secondary.end(), block_start);
+        }
+        return secondary;
+    }
+
+    std::vector<Index_> index_secondary(const tatami::VectorPtr<Index_>& indices_ptr) const {
+        std::vector<Index_> secondary;
+        if (my_extras.recycled) {
+            secondary.insert(secondary.end(), indices_ptr->begin(), indices_ptr->end());
+        }
+        return secondary;
+    }
+
+    template<bool oracle_, typename ... Args_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > dense_internal(bool row, tatami::MaybeOracle<oracle_, Index_> oracle, Index_ extent, std::vector<Index_> secondary, const Args_& ... args) const {
+        std::vector<std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > > children;
+        children.reserve(my_operands.size());
+        for (const auto& operand : my_operands) {
+            children.push_back(tatami::new_extractor<false, oracle_>(operand.get(), row, oracle, args...));
+        }
+        return std::make_unique<NaryDenseExtractor<oracle_, Operation_, Value_, Index_> >(&my_op, &my_extras, std::move(children), std::move(oracle), row, extent, std::move(secondary));
+    }
+
+    template<bool oracle_, typename ... Args_>
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > sparse_internal(bool row, tatami::MaybeOracle<oracle_, Index_> oracle, Index_ extent, const tatami::Options& opt, const Args_& ... args) const {
+        // We always need the values and (ordered) indices of the children to merge them.
+        auto copy = opt;
+        copy.sparse_extract_value = true;
+        copy.sparse_extract_index = true;
+        copy.sparse_ordered_index = true;
+
+        std::vector<std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > > children;
+        children.reserve(my_operands.size());
+        for (const auto& operand : my_operands) {
+            children.push_back(tatami::new_extractor<true, oracle_>(operand.get(), row, oracle, args..., copy));
+        }
+        return std::make_unique<NarySparseExtractor<oracle_, Operation_, Value_, Index_> >(&my_op, &my_extras, std::move(children), std::move(oracle), row, extent, opt);
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, const tatami::Options& opt) const {
+        return dense_internal<false>(row, false, (row ? ncol() : nrow()), full_secondary(row), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return dense_internal<false>(row, false, block_length, block_secondary(block_start, block_length), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        Index_ extent = indices_ptr->size();
+        auto secondary = index_secondary(indices_ptr);
+        return dense_internal<false>(row, false, extent, std::move(secondary), indices_ptr, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, const tatami::Options& opt) const {
+        if (my_sparse) {
+            return sparse_internal<false>(row, false, (row ? ncol() : nrow()), opt);
+        } else {
+            return std::make_unique<tatami::FullSparsifiedWrapper<false, Value_, Index_> >(dense(row, opt), (row ? ncol() : nrow()), opt);
+        }
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        if (my_sparse) {
+            return sparse_internal<false>(row, false, block_length, opt, block_start, block_length);
+        } else {
+            return std::make_unique<tatami::BlockSparsifiedWrapper<false, Value_, Index_> >(dense(row, block_start, block_length, opt), block_start, block_length, opt);
+        }
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        if (my_sparse) {
+            Index_ extent = indices_ptr->size();
+            return sparse_internal<false>(row, false, extent, opt, std::move(indices_ptr));
+        } else {
+            auto ext = dense(row, indices_ptr, opt);
+            return std::make_unique<tatami::IndexSparsifiedWrapper<false, Value_, Index_> >(std::move(ext), std::move(indices_ptr), opt);
+        }
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return dense_internal<true>(row, std::move(oracle), (row ? ncol() : nrow()), full_secondary(row), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return dense_internal<true>(row, std::move(oracle), block_length, block_secondary(block_start, block_length), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        Index_ extent = indices_ptr->size();
+        auto secondary = index_secondary(indices_ptr);
+        return dense_internal<true>(row, std::move(oracle), extent, std::move(secondary), indices_ptr, opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        if (my_sparse) {
+            return sparse_internal<true>(row, std::move(oracle), (row ? ncol() : nrow()), opt);
+        } else {
+            return std::make_unique<tatami::FullSparsifiedWrapper<true, Value_, Index_> >(dense(row, std::move(oracle), opt), (row ? ncol() : nrow()), opt);
+        }
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        if (my_sparse) {
+            return sparse_internal<true>(row, std::move(oracle), block_length, opt, block_start, block_length);
+        } else {
+            return std::make_unique<tatami::BlockSparsifiedWrapper<true, Value_, Index_> >(dense(row, std::move(oracle), block_start, block_length, opt), block_start, block_length, opt);
+        }
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        if (my_sparse) {
+            Index_ extent = indices_ptr->size();
+            return sparse_internal<true>(row, std::move(oracle), extent, opt, std::move(indices_ptr));
+        } else {
+            auto ext = dense(row, std::move(oracle), indices_ptr, opt);
+            return std::make_unique<tatami::IndexSparsifiedWrapper<true, Value_, Index_> >(std::move(ext), std::move(indices_ptr), opt);
+        }
+    }
+};
+
+#endif
@@ -7,6 +7,9 @@
 #include <string>
 #include <stdexcept>
 
+#include "node_info.h"
+#include "delayed_isometric_helpers.h"
+
 //[[Rcpp::export(rng=false)]]
 SEXP apply_delayed_associative_arithmetic(SEXP raw_input, Rcpp::NumericVector val, bool row, std::string op) {
     Rtatami::BoundNumericPointer input(raw_input);
@@ -39,6 +42,7 @@ SEXP apply_delayed_associative_arithmetic(SEXP raw_input, Rcpp::NumericVector va
     auto output = Rtatami::new_BoundNumericMatrix();
     output->ptr.reset(new tatami::DelayedUnaryIsometricOperation<double, double, int>(input->ptr, std::move(opptr)));
     output->original = protectorate; // propagate protection for all child objects by copying references.
+    annotate_node(output, "apply_delayed_associative_arithmetic", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("val") = val, Rcpp::Named("row") = row, Rcpp::Named("op") = op));
     return output;
 }
 
@@ -114,6 +118,7 @@ SEXP apply_delayed_nonassociative_arithmetic(SEXP raw_input, Rcpp::NumericVector
     auto output = Rtatami::new_BoundNumericMatrix();
     output->ptr.reset(new tatami::DelayedUnaryIsometricOperation<double, double, int>(input->ptr, std::move(opptr)));
     output->original = protectorate; // propagate protection for all child objects by copying references.
+    annotate_node(output, "apply_delayed_nonassociative_arithmetic", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("val") = val, Rcpp::Named("right") = right, Rcpp::Named("row") = row, Rcpp::Named("op") = op));
     return output;
 }
 
@@ -164,6 +169,7 @@ SEXP apply_delayed_comparison(SEXP raw_input, Rcpp::NumericVector val, bool row,
     auto output = Rtatami::new_BoundNumericMatrix();
     output->ptr.reset(new tatami::DelayedUnaryIsometricOperation<double, double, int>(input->ptr, std::move(opptr)));
     output->original = protectorate; // propagate protection for all child objects by copying references.
+    annotate_node(output, "apply_delayed_comparison", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("val") = val, Rcpp::Named("row") = row, Rcpp::Named("op") = op));
     return output;
 }
 
@@ -198,6 +204,7 @@ SEXP apply_delayed_boolean(SEXP raw_input, Rcpp::LogicalVector val, bool row, st
     auto output = Rtatami::new_BoundNumericMatrix();
     output->ptr.reset(new tatami::DelayedUnaryIsometricOperation<double, double, int>(input->ptr, std::move(opptr)));
     output->original = protectorate; // propagate protection for all child objects by copying references.
+    annotate_node(output, "apply_delayed_boolean", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("val") = val, Rcpp::Named("row") = row, Rcpp::Named("op") = op));
     return output;
 }
 
@@ -207,5 +214,42 @@ SEXP apply_delayed_boolean_not(SEXP raw_input) {
     auto output = Rtatami::new_BoundNumericMatrix();
     output->ptr.reset(new tatami::DelayedUnaryIsometricOperation<double, double, int>(input->ptr, std::make_shared<tatami::DelayedUnaryIsometricBooleanNotHelper<double, double, int> >()));
     output->original = input->original; // copying the reference to propagate GC protection.
+    annotate_node(output, "apply_delayed_boolean_not", Rcpp::List::create(raw_input), Rcpp::List());
+    return output;
+}
+
+//[[Rcpp::export(rng=false)]]
+SEXP apply_delayed_clamp(SEXP raw_input, Rcpp::NumericVector val, bool row, std::string op) {
+    Rtatami::BoundNumericPointer input(raw_input);
+    Rcpp::List protectorate(2);
+    protectorate[0] = input->original;
+
+    std::shared_ptr<tatami::DelayedUnaryIsometricOperationHelper<double, double, int> > opptr;
+    if (val.size() == 1) {
+        protectorate[1] = R_NilValue;
+        double v = val[0];
+        if (op == "pmin") {
+            opptr = make_elementwise_helper([v](double x) -> double { return clamp_value<false>(x, v); });
+        } else if (op == "pmax") {
+            opptr = make_elementwise_helper([v](double x) -> double { return clamp_value<true>(x, v); });
+        } else {
+            throw std::runtime_error("unknown delayed clamp operation '" + op + "'");
+        }
+    } else {
+        protectorate[1] = val;
+        tatami::ArrayView<double> view(static_cast<const double*>(val.begin()), val.size());
+        if (op == "pmin") {
+            opptr.reset(new DelayedUnaryIsometricClampVectorHelper<false, decltype(view)>(std::move(view), row));
+        } else if (op == "pmax") {
+            opptr.reset(new DelayedUnaryIsometricClampVectorHelper<true, decltype(view)>(std::move(view), row));
+        } else {
+            throw std::runtime_error("unknown delayed clamp operation '" + op + "'");
+        }
+    }
+
+    auto output = Rtatami::new_BoundNumericMatrix();
+    output->ptr.reset(new tatami::DelayedUnaryIsometricOperation<double, double, int>(input->ptr, std::move(opptr)));
+    output->original = protectorate; // propagate protection for all child objects by copying references.
+    annotate_node(output, "apply_delayed_clamp", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("val") = val, Rcpp::Named("row") = row, Rcpp::Named("op") = op));
     return output;
 }
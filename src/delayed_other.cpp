@@ -5,6 +5,8 @@
 #include <vector>
 #include <memory>
 
+#include "node_info.h"
+
 //[[Rcpp::export(rng=false)]]
 SEXP apply_delayed_subset(SEXP raw_input, Rcpp::IntegerVector subset, bool row) {
     Rtatami::BoundNumericPointer input(raw_input);
@@ -18,6 +20,7 @@ SEXP apply_delayed_subset(SEXP raw_input, Rcpp::IntegerVector subset, bool row)
     } 
 
     output->ptr = tatami::make_DelayedSubset(shared, std::move(resub), row);
+    annotate_node(output, "apply_delayed_subset", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("subset") = subset, Rcpp::Named("row") = row));
     return output;
 }
 
@@ -27,6 +30,7 @@ SEXP apply_delayed_transpose(SEXP raw_input) {
     auto output = Rtatami::new_BoundNumericMatrix();
     output->ptr.reset(new tatami::DelayedTranspose<double, int>(input->ptr));
     output->original = input->original; // copying the reference to propagate GC protection.
+    annotate_node(output, "apply_delayed_transpose", Rcpp::List::create(raw_input), Rcpp::List());
     return output;
 }
 
@@ -46,5 +50,6 @@ SEXP apply_delayed_bind(Rcpp::List input, bool row) {
     auto output = Rtatami::new_BoundNumericMatrix();
     output->ptr.reset(new tatami::DelayedBind<double, int>(std::move(collected), row));
     output->original = protectorate; // propagate protection for all child objects by copying references.
+    annotate_node(output, "apply_delayed_bind", input, Rcpp::List::create(Rcpp::Named("row") = row));
     return output;
 }
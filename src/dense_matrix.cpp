@@ -3,10 +3,43 @@
 #include <type_traits>
 #include <stdexcept>
 
+#include "altrep_matrix.h"
 #include "na_cast.h"
+#include "node_info.h"
+
+//[[Rcpp::export(rng=false)]]
+SEXP initialize_altrep_matrix(Rcpp::RObject raw_x, int nrow, int ncol, bool check_na) {
+    auto output = Rtatami::new_BoundNumericMatrix();
+    output->original = raw_x; // Hold reference to avoid GC, as the matrix only stores the SEXP.
+
+    Rcpp::Environment delayedarray = Rcpp::Environment::namespace_env("DelayedArray");
+    Rcpp::Function get_block_size = delayedarray["getAutoBlockSize"];
+    double block_size = Rcpp::as<double>(get_block_size());
+
+    if (raw_x.sexp_type() == INTSXP || raw_x.sexp_type() == LGLSXP) {
+        output->ptr.reset(new AltrepDenseMatrix<double, int, int>(raw_x, nrow, ncol, block_size));
+        if (check_na) {
+            auto masked = (raw_x.sexp_type() == INTSXP ? delayed_cast_na_integer(std::move(output->ptr)) : delayed_cast_na_logical(std::move(output->ptr)));
+            output->ptr = std::move(masked);
+        }
+
+    } else if (raw_x.sexp_type() == REALSXP) {
+        output->ptr.reset(new AltrepDenseMatrix<double, int, double>(raw_x, nrow, ncol, block_size));
+
+    } else {
+        throw std::runtime_error("'x' vector should be integer or real");
+    }
+
+    annotate_node(output, "initialize_altrep_matrix", Rcpp::List(), Rcpp::List::create(Rcpp::Named("raw_x") = raw_x, Rcpp::Named("nrow") = nrow, Rcpp::Named("ncol") = ncol, Rcpp::Named("check_na") = check_na));
+    return output;
+}
 
 //[[Rcpp::export(rng=false)]]
 SEXP initialize_dense_matrix(Rcpp::RObject raw_x, int nrow, int ncol, bool check_na) {
+    if (is_altrep_without_pointer(raw_x)) {
+        return initialize_altrep_matrix(raw_x, nrow, ncol, check_na);
+    }
+
     auto output = Rtatami::new_BoundNumericMatrix();
 
     if (raw_x.sexp_type() == INTSXP) {
@@ -39,11 +72,16 @@ SEXP initialize_dense_matrix(Rcpp::RObject raw_x, int nrow, int ncol, bool check
         throw std::runtime_error("'x' vector should be integer or real");
     }
 
+    annotate_node(output, "initialize_dense_matrix", Rcpp::List(), Rcpp::List::create(Rcpp::Named("raw_x") = raw_x, Rcpp::Named("nrow") = nrow, Rcpp::Named("ncol") = ncol, Rcpp::Named("check_na") = check_na));
     return output;
 }
 
 //[[Rcpp::export(rng=false)]]
 SEXP initialize_dense_matrix_from_vector(Rcpp::RObject raw_x, int nrow, int ncol, bool check_na) {
+    if (is_altrep_without_pointer(raw_x)) {
+        return initialize_altrep_matrix(raw_x, nrow, ncol, check_na);
+    }
+
     auto output = Rtatami::new_BoundNumericMatrix();
 
     if (raw_x.sexp_type() == LGLSXP) {
@@ -66,5 +104,6 @@ SEXP initialize_dense_matrix_from_vector(Rcpp::RObject raw_x, int nrow, int ncol
         throw std::runtime_error("'x' vector should be integer or real");
     }
 
+    annotate_node(output, "initialize_dense_matrix_from_vector", Rcpp::List(), Rcpp::List::create(Rcpp::Named("raw_x") = raw_x, Rcpp::Named("nrow") = nrow, Rcpp::Named("ncol") = ncol, Rcpp::Named("check_na") = check_na));
     return output;
 }
@@ -0,0 +1,127 @@
+#include "executor_profile.h"
+
+ExecutorProfile& executor_profile() {
+    static ExecutorProfile profile;
+    return profile;
+}
+
+void ExecutorProfile::enable(bool enabled) {
+    // This should only ever be called from R, so we can take the current thread as the main thread.
+    my_main = std::this_thread::get_id();
+    my_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void ExecutorProfile::reset() {
+    // This should only ever be called from R, i.e., outside of any parallel section,
+    // so no worker thread will be holding a reference to the existing records.
+    std::lock_guard<std::mutex> lck(my_lock);
+    my_threads.clear();
+    ++my_generation;
+    my_pending = 0;
+    my_max_depth = 0;
+    my_depth_sum = 0;
+    my_depth_count = 0;
+}
+
+ExecutorThreadRecord& ExecutorProfile::thread_record() {
+    // Caching the record in thread-local storage to avoid locking on every extraction call.
+    // We check the generation to avoid using a stale pointer after reset().
+    thread_local ExecutorThreadRecord* cached = NULL;
+    thread_local std::size_t cached_generation = 0;
+
+    auto current_generation = my_generation.load(std::memory_order_relaxed);
+    if (cached != NULL && cached_generation == current_generation) {
+        return *cached;
+    }
+
+    auto id = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lck(my_lock);
+    for (auto& record : my_threads) {
+        if (record.id == id) {
+            cached = &record;
+            cached_generation = current_generation;
+            return record;
+        }
+    }
+
+    auto& record = my_threads.emplace_back();
+    record.id = id;
+    record.main = (id == my_main);
+    cached = &record;
+    cached_generation = current_generation;
+    return record;
+}
+
+void ExecutorProfile::enqueue() {
+    // The queue depth is the number of other jobs that are already waiting for the main thread when a worker submits its own job.
+    auto depth = my_pending.fetch_add(1, std::memory_order_relaxed);
+    auto current_max = my_max_depth.load(std::memory_order_relaxed);
+    while (depth > current_max && !my_max_depth.compare_exchange_weak(current_max, depth, std::memory_order_relaxed)) {}
+    my_depth_sum.fetch_add(depth, std::memory_order_relaxed);
+    my_depth_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ExecutorProfile::dequeue() {
+    my_pending.fetch_sub(1, std::memory_order_relaxed);
+}
+
+Rcpp::List ExecutorProfile::summarize() const {
+    std::lock_guard<std::mutex> lck(my_lock);
+
+    auto nthreads = my_threads.size();
+    Rcpp::LogicalVector main(nthreads);
+    Rcpp::NumericVector extractions(nthreads), extraction_seconds(nthreads), jobs(nthreads), wait_seconds(nthreads), run_seconds(nthreads);
+    double total_extractions = 0, total_jobs = 0, total_wait = 0, total_run = 0;
+    for (decltype(nthreads) t = 0; t < nthreads; ++t) {
+        const auto& record = my_threads[t];
+        main[t] = record.main;
+        extractions[t] = record.extractions.load(std::memory_order_relaxed);
+        extraction_seconds[t] = static_cast<double>(record.extraction_nanoseconds.load(std::memory_order_relaxed)) / 1e9;
+        jobs[t] = record.jobs.load(std::memory_order_relaxed);
+        wait_seconds[t] = static_cast<double>(record.wait_nanoseconds.load(std::memory_order_relaxed)) / 1e9;
+        run_seconds[t] = static_cast<double>(record.run_nanoseconds.load(std::memory_order_relaxed)) / 1e9;
+        total_extractions += extractions[t];
+        total_jobs += jobs[t];
+        total_wait += wait_seconds[t];
+        total_run += run_seconds[t];
+    }
+
+    auto depth_count = my_depth_count.load(std::memory_order_relaxed);
+    double mean_depth = (depth_count ? static_cast<double>(my_depth_sum.load(std::memory_order_relaxed)) / depth_count : 0);
+
+    return Rcpp::List::create(
+        Rcpp::Named("threads") = Rcpp::List::create(
+            Rcpp::Named("main") = main,
+            Rcpp::Named("extractions") = extractions,
+            Rcpp::Named("extraction.seconds") = extraction_seconds,
+            Rcpp::Named("jobs") = jobs,
+            Rcpp::Named("wait.seconds") = wait_seconds,
+            Rcpp::Named("run.seconds") = run_seconds
+        ),
+        Rcpp::Named("extractions") = total_extractions,
+        Rcpp::Named("jobs") = total_jobs,
+        Rcpp::Named("wait.seconds") = total_wait,
+        Rcpp::Named("run.seconds") = total_run,
+        Rcpp::Named("max.queue.depth") = static_cast<double>(my_max_depth.load(std::memory_order_relaxed)),
+        Rcpp::Named("mean.queue.depth") = mean_depth
+    );
+}
+
+//[[Rcpp::export(rng=false)]]
+Rcpp::LogicalVector set_executor_profiling(bool enabled) {
+    auto& profile = executor_profile();
+    bool old = profile.enabled();
+    profile.enable(enabled);
+    return Rcpp::LogicalVector::create(old);
+}
+
+//[[Rcpp::export(rng=false)]]
+Rcpp::List get_executor_profile() {
+    return executor_profile().summarize();
+}
+
+//[[Rcpp::export(rng=false)]]
+SEXP reset_executor_profile() {
+    executor_profile().reset();
+    return R_NilValue;
+}
@@ -0,0 +1,320 @@
+#ifndef BEACHMAT_EXECUTOR_PROFILE_H
+#define BEACHMAT_EXECUTOR_PROFILE_H
+
+#include "Rtatami.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+/**
+ * Usage statistics for a single thread that extracted data from an R-backed matrix.
+ * Extraction calls are timed from the perspective of the calling thread, so they include any time spent waiting for the main thread as well as cache hits.
+ * Executor jobs are only those requests that were actually submitted to the main thread, with the time spent waiting in the queue and running on the main thread recorded separately.
+ */
+struct ExecutorThreadRecord {
+    std::thread::id id;
+    bool main = false;
+    std::atomic<std::size_t> extractions = 0;
+    std::atomic<std::uint64_t> extraction_nanoseconds = 0;
+    std::atomic<std::size_t> jobs = 0;
+    std::atomic<std::uint64_t> wait_nanoseconds = 0;
+    std::atomic<std::uint64_t> run_nanoseconds = 0;
+};
+
+class ExecutorProfile {
+public:
+    void enable(bool enabled);
+
+    bool enabled() const {
+        return my_enabled.load(std::memory_order_relaxed);
+    }
+
+    void reset();
+
+    Rcpp::List summarize() const;
+
+public:
+    // Called by ProfiledTimer and profiled_run() only.
+    ExecutorThreadRecord& thread_record();
+
+    void enqueue();
+
+    void dequeue();
+
+    bool is_main() const {
+        return std::this_thread::get_id() == my_main;
+    }
+
+private:
+    std::atomic<bool> my_enabled = false;
+    std::thread::id my_main;
+
+    mutable std::mutex my_lock;
+    std::deque<ExecutorThreadRecord> my_threads; // deque for stable addresses.
+    std::atomic<std::size_t> my_generation = 0;
+
+    std::atomic<std::size_t> my_pending = 0;
+    std::atomic<std::size_t> my_max_depth = 0;
+    std::atomic<std::size_t> my_depth_sum = 0;
+    std::atomic<std::size_t> my_depth_count = 0;
+};
+
+ExecutorProfile& executor_profile();
+
+/**
+ * Times a single extraction call from an R-backed matrix,
+ * recording the elapsed time in the global `executor_profile()`.
+ */
+class ProfiledTimer {
+public:
+    ProfiledTimer() :
+        my_profile(executor_profile()),
+        my_start(std::chrono::steady_clock::now())
+    {}
+
+    ~ProfiledTimer() {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - my_start);
+        auto& record = my_profile.thread_record();
+        record.extractions.fetch_add(1, std::memory_order_relaxed);
+        record.extraction_nanoseconds.fetch_add(elapsed.count(), std::memory_order_relaxed);
+    }
+
+    ProfiledTimer(const ProfiledTimer&) = delete;
+    ProfiledTimer& operator=(const ProfiledTimer&) = delete;
+
+private:
+    ExecutorProfile& my_profile;
+    std::chrono::steady_clock::time_point my_start;
+};
+
+/**
+ * Submits `fun` for execution on the main thread.
+ * Threads of a background job (see `AsyncJob`) submit to the job's own `Rtatami::DetachedExecutor`, which is serviced whenever the main thread checks in on the job.
+ * All other threads use `tatami_r::executor()`.
+ */
+template<class Function_>
+void run_on_main(Function_ fun) {
+    auto detached = Rtatami::detached_executor();
+    if (detached) {
+        detached->run(std::move(fun));
+        return;
+    }
+    if (Rtatami::is_detached()) {
+        // The process-wide executor would run 'fun' directly on this thread if the main thread is not in a parallel section.
+        throw std::runtime_error("cannot call into R from a background job without its own executor");
+    }
+    tatami_r::executor().run(std::move(fun));
+}
+
+/**
+ * Submits `fun` for execution on the main thread via `run_on_main()`.
+ * If profiling is enabled, the job is recorded in the global `executor_profile()` against the requesting thread,
+ * with separate timings for the wait in the executor's queue and the run on the main thread.
+ */
+template<class Function_>
+void profiled_run(Function_ fun) {
+    auto& profile = executor_profile();
+    if (!profile.enabled()) {
+        run_on_main(std::move(fun));
+        return;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    bool main = profile.is_main();
+    auto requested = Clock::now();
+    Clock::time_point started, finished;
+    bool has_started = false;
+
+    struct Finisher {
+        Clock::time_point& finished;
+        ~Finisher() {
+            finished = Clock::now();
+        }
+    };
+
+    if (!main) {
+        profile.enqueue();
+    }
+
+    auto record = [&]() -> void {
+        if (!has_started) {
+            if (!main) {
+                profile.dequeue();
+            }
+            return;
+        }
+        auto& current = profile.thread_record();
+        current.jobs.fetch_add(1, std::memory_order_relaxed);
+        if (!main) {
+            // Jobs from the main thread are run directly, so they never wait.
+            current.wait_nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(started - requested).count(), std::memory_order_relaxed);
+        }
+        current.run_nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(finished - started).count(), std::memory_order_relaxed);
+    };
+
+    try {
+        run_on_main([&]() -> void {
+            // This runs on the main thread, so the requesting thread is no longer waiting in the queue.
+            started = Clock::now();
+            has_started = true;
+            if (!main) {
+                profile.dequeue();
+            }
+            Finisher finisher{ finished };
+            fun();
+        });
+    } catch (...) {
+        record();
+        throw;
+    }
+    record();
+}
+
+template<bool oracle_, typename Value_, typename Index_>
+class ProfiledDenseExtractor final : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+public:
+    ProfiledDenseExtractor(std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > ext) : my_ext(std::move(ext)) {}
+
+    const Value_* fetch(Index_ i, Value_* buffer) {
+        ProfiledTimer timer;
+        return my_ext->fetch(i, buffer);
+    }
+
+private:
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > my_ext;
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class ProfiledSparseExtractor final : public tatami::SparseExtractor<oracle_, Value_, Index_> {
+public:
+    ProfiledSparseExtractor(std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > ext) : my_ext(std::move(ext)) {}
+
+    tatami::SparseRange<Value_, Index_> fetch(Index_ i, Value_* vbuffer, Index_* ibuffer) {
+        ProfiledTimer timer;
+        return my_ext->fetch(i, vbuffer, ibuffer);
+    }
+
+private:
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > my_ext;
+};
+
+/**
+ * Wraps an R-backed matrix so that each extraction call is timed.
+ * This does not count executor jobs, which are recorded by `profiled_run()` instead.
+ * This is only used for matrices that need to call into the R interpreter,
+ * as the timing overhead would be noticeable for natively supported matrices.
+ */
+template<typename Value_, typename Index_>
+class ProfiledMatrix final : public tatami::Matrix<Value_, Index_> {
+public:
+    ProfiledMatrix(std::shared_ptr<const tatami::Matrix<Value_, Index_> > matrix) : my_matrix(std::move(matrix)) {}
+
+private:
+    std::shared_ptr<const tatami::Matrix<Value_, Index_> > my_matrix;
+
+public:
+    Index_ nrow() const {
+        return my_matrix->nrow();
+    }
+
+    Index_ ncol() const {
+        return my_matrix->ncol();
+    }
+
+    bool is_sparse() const {
+        return my_matrix->is_sparse();
+    }
+
+    double is_sparse_proportion() const {
+        return my_matrix->is_sparse_proportion();
+    }
+
+    bool prefer_rows() const {
+        return my_matrix->prefer_rows();
+    }
+
+    double prefer_rows_proportion() const {
+        return my_matrix->prefer_rows_proportion();
+    }
+
+    bool uses_oracle(bool row) const {
+        return my_matrix->uses_oracle(row);
+    }
+
+    using tatami::Matrix<Value_, Index_>::dense;
+
+    using tatami::Matrix<Value_, Index_>::sparse;
+
+private:
+    template<bool oracle_, typename ... Args_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > dense_internal(bool row, tatami::MaybeOracle<oracle_, Index_> oracle, Args_&& ... args) const {
+        return std::make_unique<ProfiledDenseExtractor<oracle_, Value_, Index_> >(
+            tatami::new_extractor<false, oracle_>(*my_matrix, row, std::move(oracle), std::forward<Args_>(args)...)
+        );
+    }
+
+    template<bool oracle_, typename ... Args_>
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > sparse_internal(bool row, tatami::MaybeOracle<oracle_, Index_> oracle, Args_&& ... args) const {
+        return std::make_unique<ProfiledSparseExtractor<oracle_, Value_, Index_> >(
+            tatami::new_extractor<true, oracle_>(*my_matrix, row, std::move(oracle), std::forward<Args_>(args)...)
+        );
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, const tatami::Options& opt) const {
+        return dense_internal<false>(row, false, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return dense_internal<false>(row, false, block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return dense_internal<false>(row, false, std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, const tatami::Options& opt) const {
+        return sparse_internal<false>(row, false, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return sparse_internal<false>(row, false, block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return sparse_internal<false>(row, false, std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return dense_internal<true>(row, std::move(oracle), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return dense_internal<true>(row, std::move(oracle), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return dense_internal<true>(row, std::move(oracle), std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return sparse_internal<true>(row, std::move(oracle), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return sparse_internal<true>(row, std::move(oracle), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return sparse_internal<true>(row, std::move(oracle), std::move(indices_ptr), opt);
+    }
+};
+
+#endif
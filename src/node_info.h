@@ -0,0 +1,74 @@
+#ifndef BEACHMAT_NODE_INFO_H
+#define BEACHMAT_NODE_INFO_H
+
+#include "Rtatami.h"
+#include "Rcpp.h"
+
+#include <string>
+
+/**
+ * Record how a node of the C++ tree was constructed, by attaching an attribute to its external pointer.
+ * `type` should be the name of the exported function that created the node,
+ * `children` should contain the external pointers for the child nodes,
+ * and `args` should contain all other arguments that were passed to the function.
+ * This is used by tatami.describe() to inspect the tree after construction.
+ *
+ * We use an attribute rather than adding a member to `Rtatami::BoundNumericMatrix`,
+ * as the latter may be created by other packages that were compiled against an older version of the header.
+ */
+inline void annotate_node(Rtatami::BoundNumericPointer& output, const std::string& type, Rcpp::List children, Rcpp::List args) {
+    output.attr("tatami.node") = Rcpp::List::create(
+        Rcpp::Named("type") = type,
+        Rcpp::Named("children") = children,
+        Rcpp::Named("args") = args
+    );
+}
+
+/**
+ * Check whether any node in the tree satisfies `pred`, which should accept the node type.
+ * Nodes without annotations (e.g., created by other packages like beachmat.hdf5) are passed to `pred` with an empty type.
+ */
+template<class Predicate_>
+bool has_node_type(SEXP ptr, Predicate_ pred) {
+    Rcpp::RObject node(Rf_getAttrib(ptr, Rf_install("tatami.node")));
+    if (node.isNULL()) {
+        return pred(std::string());
+    }
+
+    Rcpp::List info(node);
+    if (pred(Rcpp::as<std::string>(info["type"]))) {
+        return true;
+    }
+
+    Rcpp::List children(info["children"]);
+    for (R_xlen_t c = 0, nchildren = children.size(); c < nchildren; ++c) {
+        if (has_node_type(static_cast<SEXP>(children[c]), pred)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Check whether any node in the tree might call back into R, i.e., one created by initialize_unknown_matrix(), apply_delayed_callback() or initialize_altrep_matrix().
+ * Nodes without annotations are also assumed to use the executor, as we don't know how they were constructed.
+ */
+inline bool has_unknown_node(SEXP ptr) {
+    return has_node_type(ptr, [](const std::string& type) -> bool {
+        return type.empty() || type == "initialize_unknown_matrix" || type == "apply_delayed_callback" || type == "initialize_altrep_matrix";
+    });
+}
+
+/**
+ * Check whether any node in the tree might call back into R via the process-wide `tatami_r::executor()`,
+ * i.e., from the **tatami_r** fallback in initialize_unknown_matrix() or from nodes without annotations.
+ * Such calls cannot be redirected to the `Rtatami::DetachedExecutor` of a background job,
+ * unlike those from apply_delayed_callback() or initialize_altrep_matrix() that go through run_on_main().
+ */
+inline bool has_unserviceable_node(SEXP ptr) {
+    return has_node_type(ptr, [](const std::string& type) -> bool {
+        return type.empty() || type == "initialize_unknown_matrix";
+    });
+}
+
+#endif
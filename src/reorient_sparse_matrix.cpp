@@ -0,0 +1,42 @@
+#include "Rtatami.h"
+#include "Rcpp.h"
+#include "tatami/tatami.hpp"
+
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+#include "reoriented_matrix.h"
+#include "node_info.h"
+
+//[[Rcpp::export(rng=false)]]
+SEXP reorient_sparse_matrix(SEXP raw_input, int threads) {
+    if (threads < 1) {
+        throw std::runtime_error("'threads' should be a positive integer");
+    }
+
+    Rtatami::BoundNumericPointer input(raw_input);
+    const auto& shared = input->ptr;
+    if (!shared->is_sparse()) {
+        throw std::runtime_error("only sparse matrices can be reoriented");
+    }
+
+    // Building a compressed sparse copy where the non-preferred dimension is the primary dimension.
+    bool row = !shared->prefer_rows();
+    auto contents = tatami::retrieve_compressed_sparse_contents<double, int>(shared.get(), row, /* two_pass = */ false, threads);
+    auto reoriented = std::make_shared<tatami::CompressedSparseMatrix<double, int, std::vector<double>, std::vector<int>, std::vector<std::size_t> > >(
+        shared->nrow(),
+        shared->ncol(),
+        std::move(contents.value),
+        std::move(contents.index),
+        std::move(contents.pointers),
+        row,
+        /* check = */ false
+    );
+
+    auto output = Rtatami::new_BoundNumericMatrix();
+    output->ptr.reset(new ReorientedMatrix<double, int>(shared, std::move(reoriented)));
+    output->original = input->original; // copying the reference to propagate GC protection, the reoriented copy is owned by C++.
+    annotate_node(output, "reorient_sparse_matrix", Rcpp::List::create(raw_input), Rcpp::List::create(Rcpp::Named("threads") = threads));
+    return output;
+}
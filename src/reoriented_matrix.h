@@ -0,0 +1,122 @@
+#ifndef BEACHMAT_REORIENTED_MATRIX_H
+#define BEACHMAT_REORIENTED_MATRIX_H
+
+#include "Rtatami.h"
+
+#include <memory>
+
+/**
+ * Holds a sparse matrix in both row- and column-major orientations.
+ * Extraction requests are routed to whichever copy stores the requested dimension as its primary dimension,
+ * so that row-wise access to a compressed sparse column matrix (and vice versa) becomes a sequential read.
+ */
+template<typename Value_, typename Index_>
+class ReorientedMatrix final : public tatami::Matrix<Value_, Index_> {
+public:
+    ReorientedMatrix(std::shared_ptr<const tatami::Matrix<Value_, Index_> > matrix, std::shared_ptr<const tatami::Matrix<Value_, Index_> > reoriented) :
+        my_matrix(std::move(matrix)), my_reoriented(std::move(reoriented)), my_reoriented_row(my_reoriented->prefer_rows()) {}
+
+private:
+    std::shared_ptr<const tatami::Matrix<Value_, Index_> > my_matrix;
+    std::shared_ptr<const tatami::Matrix<Value_, Index_> > my_reoriented;
+    bool my_reoriented_row;
+
+    const tatami::Matrix<Value_, Index_>& choose(bool row) const {
+        return (row == my_reoriented_row ? *my_reoriented : *my_matrix);
+    }
+
+public:
+    Index_ nrow() const {
+        return my_matrix->nrow();
+    }
+
+    Index_ ncol() const {
+        return my_matrix->ncol();
+    }
+
+    bool is_sparse() const {
+        return my_matrix->is_sparse();
+    }
+
+    double is_sparse_proportion() const {
+        return my_matrix->is_sparse_proportion();
+    }
+
+    bool prefer_rows() const {
+        return my_matrix->prefer_rows();
+    }
+
+    double prefer_rows_proportion() const {
+        return my_matrix->prefer_rows_proportion();
+    }
+
+    bool uses_oracle(bool row) const {
+        return choose(row).uses_oracle(row);
+    }
+
+    using tatami::Matrix<Value_, Index_>::dense;
+
+    using tatami::Matrix<Value_, Index_>::sparse;
+
+private:
+    template<bool oracle_, typename ... Args_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > dense_internal(bool row, tatami::MaybeOracle<oracle_, Index_> oracle, Args_&& ... args) const {
+        return tatami::new_extractor<false, oracle_>(choose(row), row, std::move(oracle), std::forward<Args_>(args)...);
+    }
+
+    template<bool oracle_, typename ... Args_>
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > sparse_internal(bool row, tatami::MaybeOracle<oracle_, Index_> oracle, Args_&& ... args) const {
+        return tatami::new_extractor<true, oracle_>(choose(row), row, std::move(oracle), std::forward<Args_>(args)...);
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, const tatami::Options& opt) const {
+        return dense_internal<false>(row, false, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return dense_internal<false>(row, false, block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return dense_internal<false>(row, false, std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, const tatami::Options& opt) const {
+        return sparse_internal<false>(row, false, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return sparse_internal<false>(row, false, block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return sparse_internal<false>(row, false, std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return dense_internal<true>(row, std::move(oracle), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return dense_internal<true>(row, std::move(oracle), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return dense_internal<true>(row, std::move(oracle), std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return sparse_internal<true>(row, std::move(oracle), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return sparse_internal<true>(row, std::move(oracle), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return sparse_internal<true>(row, std::move(oracle), std::move(indices_ptr), opt);
+    }
+};
+
+#endif
@@ -0,0 +1,20 @@
+#include "Rtatami.h"
+#include "Rcpp.h"
+
+#include "node_info.h"
+#include "rle_matrix.h"
+
+#include <stdexcept>
+
+//[[Rcpp::export(rng=false)]]
+SEXP initialize_rle_matrix(Rcpp::NumericVector values, Rcpp::IntegerVector lengths, int nrow, int ncol) {
+    if (values.size() != lengths.size()) {
+        throw std::runtime_error("run values and lengths should have the same length");
+    }
+
+    auto output = Rtatami::new_BoundNumericMatrix();
+    output->ptr.reset(new RleMatrix<double, int>(nrow, ncol, static_cast<const double*>(values.begin()), static_cast<const int*>(lengths.begin()), values.size()));
+    output->original = Rcpp::List::create(values, lengths); // holding the runs to protect them from GC.
+    annotate_node(output, "initialize_rle_matrix", Rcpp::List(), Rcpp::List::create(Rcpp::Named("values") = values, Rcpp::Named("lengths") = lengths, Rcpp::Named("nrow") = nrow, Rcpp::Named("ncol") = ncol));
+    return output;
+}
@@ -0,0 +1,378 @@
+#ifndef BEACHMAT_RLE_MATRIX_H
+#define BEACHMAT_RLE_MATRIX_H
+
+#include "Rtatami.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Run-length encoding of a matrix in column-major order, as used by DelayedArray's RleArraySeed.
+ * Runs are located by the cumulative positions of their ends, so that any element can be found by binary search.
+ */
+template<typename Index_>
+class RleRuns {
+public:
+    RleRuns(Index_ nrow, Index_ ncol, const double* values, const int* lengths, std::size_t nruns) : my_nrow(nrow), my_ncol(ncol), my_values(values), my_ends(nruns) {
+        std::size_t total = 0;
+        for (std::size_t r = 0; r < nruns; ++r) {
+            if (lengths[r] < 0) {
+                throw std::runtime_error("run lengths should be non-negative");
+            }
+            total += lengths[r];
+            my_ends[r] = total;
+            if (values[r] != 0) {
+                my_nonzero += lengths[r];
+            }
+        }
+        if (total != static_cast<std::size_t>(nrow) * static_cast<std::size_t>(ncol)) {
+            throw std::runtime_error("total length of runs should be equal to the number of matrix elements");
+        }
+    }
+
+    Index_ nrow() const {
+        return my_nrow;
+    }
+
+    Index_ ncol() const {
+        return my_ncol;
+    }
+
+    std::size_t nonzero() const {
+        return my_nonzero;
+    }
+
+    std::size_t position(bool row, Index_ i, Index_ s) const {
+        if (row) {
+            return static_cast<std::size_t>(s) * my_nrow + i;
+        } else {
+            return static_cast<std::size_t>(i) * my_nrow + s;
+        }
+    }
+
+    /**
+     * Find the run containing `pos`, starting from the run at `hint`.
+     * This is constant time when successive positions lie in the same or the next run.
+     */
+    std::size_t find(std::size_t pos, std::size_t hint) const {
+        if (pos < my_ends[hint]) {
+            if (hint == 0 || pos >= my_ends[hint - 1]) {
+                return hint;
+            }
+            return std::upper_bound(my_ends.begin(), my_ends.begin() + hint, pos) - my_ends.begin();
+        }
+        if (hint + 1 < my_ends.size() && pos < my_ends[hint + 1]) {
+            return hint + 1;
+        }
+        return std::upper_bound(my_ends.begin() + hint + 1, my_ends.end(), pos) - my_ends.begin();
+    }
+
+    double value(std::size_t run) const {
+        return my_values[run];
+    }
+
+    std::size_t end(std::size_t run) const {
+        return my_ends[run];
+    }
+
+    std::size_t nruns() const {
+        return my_ends.size();
+    }
+
+private:
+    Index_ my_nrow, my_ncol;
+    const double* my_values;
+    std::vector<std::size_t> my_ends;
+    std::size_t my_nonzero = 0;
+};
+
+/**
+ * Selection of the secondary dimension for an extractor, i.e., a contiguous block or an indexed subset.
+ */
+template<typename Index_>
+struct RleSelection {
+    RleSelection(Index_ start, Index_ length) : start(start), length(length) {}
+    RleSelection(tatami::VectorPtr<Index_> indices) : length(indices->size()), indices(std::move(indices)) {}
+
+    Index_ start = 0;
+    Index_ length;
+    tatami::VectorPtr<Index_> indices;
+
+    Index_ get(Index_ j) const {
+        return (indices ? (*indices)[j] : start + j);
+    }
+};
+
+/**
+ * Walk through the selected elements of one row or column, calling `fun(j, value, n)` for each stretch of `n` elements with the same value,
+ * starting from the `j`-th element of the selection.
+ * Column-wise extraction of a contiguous block only needs to visit each overlapping run once.
+ */
+template<typename Index_, class Function_>
+void walk_rle(const RleRuns<Index_>& runs, bool row, Index_ i, const RleSelection<Index_>& selection, std::size_t& hint, Function_ fun) {
+    if (row || selection.indices) {
+        for (Index_ j = 0; j < selection.length; ++j) {
+            hint = runs.find(runs.position(row, i, selection.get(j)), hint);
+            fun(j, runs.value(hint), 1);
+        }
+        return;
+    }
+
+    std::size_t pos = runs.position(false, i, selection.start);
+    Index_ j = 0;
+    while (j < selection.length) {
+        hint = runs.find(pos, hint);
+        Index_ n = std::min(runs.end(hint) - pos, static_cast<std::size_t>(selection.length - j));
+        fun(j, runs.value(hint), n);
+        j += n;
+        pos += n;
+    }
+}
+
+template<bool oracle_, typename Value_, typename Index_>
+class RleDenseExtractor final : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+public:
+    RleDenseExtractor(const RleRuns<Index_>* runs, tatami::MaybeOracle<oracle_, Index_> oracle, bool row, RleSelection<Index_> selection) :
+        my_runs(runs), my_oracle(std::move(oracle)), my_row(row), my_selection(std::move(selection)) {}
+
+    const Value_* fetch(Index_ i, Value_* buffer) {
+        if constexpr(oracle_) {
+            i = my_oracle->get(my_used);
+            ++my_used;
+        }
+        walk_rle(*my_runs, my_row, i, my_selection, my_hint, [&](Index_ j, double val, Index_ n) -> void {
+            std::fill_n(buffer + j, n, val);
+        });
+        return buffer;
+    }
+
+private:
+    const RleRuns<Index_>* my_runs;
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    typename std::conditional<oracle_, std::size_t, bool>::type my_used = 0;
+    bool my_row;
+    RleSelection<Index_> my_selection;
+    std::size_t my_hint = 0;
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class RleSparseExtractor final : public tatami::SparseExtractor<oracle_, Value_, Index_> {
+public:
+    RleSparseExtractor(const RleRuns<Index_>* runs, tatami::MaybeOracle<oracle_, Index_> oracle, bool row, RleSelection<Index_> selection, const tatami::Options& opt) :
+        my_runs(runs),
+        my_oracle(std::move(oracle)),
+        my_row(row),
+        my_selection(std::move(selection)),
+        my_extract_value(opt.sparse_extract_value),
+        my_extract_index(opt.sparse_extract_index)
+    {}
+
+    tatami::SparseRange<Value_, Index_> fetch(Index_ i, Value_* value_buffer, Index_* index_buffer) {
+        if constexpr(oracle_) {
+            i = my_oracle->get(my_used);
+            ++my_used;
+        }
+
+        // Runs of zeros are skipped entirely.
+        Index_ count = 0;
+        walk_rle(*my_runs, my_row, i, my_selection, my_hint, [&](Index_ j, double val, Index_ n) -> void {
+            if (val == 0) {
+                return;
+            }
+            if (my_extract_value) {
+                std::fill_n(value_buffer + count, n, val);
+            }
+            if (my_extract_index) {
+                for (Index_ k = 0; k < n; ++k) {
+                    index_buffer[count + k] = my_selection.get(j + k);
+                }
+            }
+            count += n;
+        });
+
+        return tatami::SparseRange<Value_, Index_>(count, (my_extract_value ? value_buffer : NULL), (my_extract_index ? index_buffer : NULL));
+    }
+
+private:
+    const RleRuns<Index_>* my_runs;
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    typename std::conditional<oracle_, std::size_t, bool>::type my_used = 0;
+    bool my_row;
+    RleSelection<Index_> my_selection;
+    bool my_extract_value, my_extract_index;
+    std::size_t my_hint = 0;
+};
+
+/**
+ * Matrix that directly references the run values and lengths of an RleArraySeed.
+ * Extraction only expands the runs overlapping the requested rows or columns.
+ * The matrix is considered to be sparse if most of its elements lie in runs of zeros.
+ */
+template<typename Value_, typename Index_>
+class RleMatrix final : public tatami::Matrix<Value_, Index_> {
+public:
+    RleMatrix(Index_ nrow, Index_ ncol, const double* values, const int* lengths, std::size_t nruns) : my_runs(nrow, ncol, values, lengths, nruns) {}
+
+private:
+    RleRuns<Index_> my_runs;
+
+public:
+    Index_ nrow() const {
+        return my_runs.nrow();
+    }
+
+    Index_ ncol() const {
+        return my_runs.ncol();
+    }
+
+    bool is_sparse() const {
+        return is_sparse_proportion() > 0.5;
+    }
+
+    double is_sparse_proportion() const {
+        double total = static_cast<double>(my_runs.nrow()) * static_cast<double>(my_runs.ncol());
+        return (total > 0 ? 1 - my_runs.nonzero() / total : 0);
+    }
+
+    bool prefer_rows() const {
+        return false;
+    }
+
+    double prefer_rows_proportion() const {
+        return 0;
+    }
+
+    bool uses_oracle(bool) const {
+        return false;
+    }
+
+    const RleRuns<Index_>& runs() const {
+        return my_runs;
+    }
+
+    using tatami::Matrix<Value_, Index_>::dense;
+
+    using tatami::Matrix<Value_, Index_>::sparse;
+
+private:
+    Index_ secondary(bool row) const {
+        return (row ? my_runs.ncol() : my_runs.nrow());
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, const tatami::Options&) const {
+        return std::make_unique<RleDenseExtractor<false, Value_, Index_> >(&my_runs, false, row, RleSelection<Index_>(0, secondary(row)));
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, Index_ block_start, Index_ block_length, const tatami::Options&) const {
+        return std::make_unique<RleDenseExtractor<false, Value_, Index_> >(&my_runs, false, row, RleSelection<Index_>(block_start, block_length));
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options&) const {
+        return std::make_unique<RleDenseExtractor<false, Value_, Index_> >(&my_runs, false, row, RleSelection<Index_>(std::move(indices_ptr)));
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, const tatami::Options& opt) const {
+        return std::make_unique<RleSparseExtractor<false, Value_, Index_> >(&my_runs, false, row, RleSelection<Index_>(0, secondary(row)), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return std::make_unique<RleSparseExtractor<false, Value_, Index_> >(&my_runs, false, row, RleSelection<Index_>(block_start, block_length), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return std::make_unique<RleSparseExtractor<false, Value_, Index_> >(&my_runs, false, row, RleSelection<Index_>(std::move(indices_ptr)), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options&) const {
+        return std::make_unique<RleDenseExtractor<true, Value_, Index_> >(&my_runs, std::move(oracle), row, RleSelection<Index_>(0, secondary(row)));
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options&) const {
+        return std::make_unique<RleDenseExtractor<true, Value_, Index_> >(&my_runs, std::move(oracle), row, RleSelection<Index_>(block_start, block_length));
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options&) const {
+        return std::make_unique<RleDenseExtractor<true, Value_, Index_> >(&my_runs, std::move(oracle), row, RleSelection<Index_>(std::move(indices_ptr)));
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return std::make_unique<RleSparseExtractor<true, Value_, Index_> >(&my_runs, std::move(oracle), row, RleSelection<Index_>(0, secondary(row)), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        return std::make_unique<RleSparseExtractor<true, Value_, Index_> >(&my_runs, std::move(oracle), row, RleSelection<Index_>(block_start, block_length), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return std::make_unique<RleSparseExtractor<true, Value_, Index_> >(&my_runs, std::move(oracle), row, RleSelection<Index_>(std::move(indices_ptr)), opt);
+    }
+};
+
+/**
+ * Compute row or column sums directly from the runs, without expanding them into individual elements.
+ * For column sums, each run contributes its value multiplied by its overlap with each column.
+ * For row sums, runs spanning complete columns contribute to all rows at once.
+ */
+template<typename Index_>
+void rle_sums(const RleRuns<Index_>& runs, bool row, double* output) {
+    const std::size_t NR = runs.nrow();
+    std::fill_n(output, (row ? runs.nrow() : runs.ncol()), 0.0);
+    if (NR == 0) {
+        return;
+    }
+
+    double full_total = 0; // total contribution from runs spanning complete columns, for row sums.
+    std::size_t start = 0;
+
+    for (std::size_t r = 0, nruns = runs.nruns(); r < nruns; ++r) {
+        std::size_t end = runs.end(r);
+        double val = runs.value(r);
+        if (val == 0 || start == end) {
+            start = end;
+            continue;
+        }
+
+        std::size_t first_col = start / NR, last_col = (end - 1) / NR;
+        if (!row) {
+            if (first_col == last_col) {
+                output[first_col] += val * (end - start);
+            } else {
+                output[first_col] += val * ((first_col + 1) * NR - start);
+                for (std::size_t c = first_col + 1; c < last_col; ++c) {
+                    output[c] += val * NR;
+                }
+                output[last_col] += val * (end - last_col * NR);
+            }
+
+        } else {
+            std::size_t first_row = start % NR;
+            if (first_col == last_col) {
+                for (std::size_t p = first_row, last = first_row + (end - start); p < last; ++p) {
+                    output[p] += val;
+                }
+            } else {
+                for (std::size_t p = first_row; p < NR; ++p) {
+                    output[p] += val;
+                }
+                full_total += val * (last_col - first_col - 1);
+                for (std::size_t p = 0, last = end - last_col * NR; p < last; ++p) {
+                    output[p] += val;
+                }
+            }
+        }
+
+        start = end;
+    }
+
+    if (row) {
+        for (std::size_t p = 0; p < NR; ++p) {
+            output[p] += full_total;
+        }
+    }
+}
+
+#endif
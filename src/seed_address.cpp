@@ -0,0 +1,11 @@
+#include "Rcpp.h"
+
+#include <cstdio>
+
+//[[Rcpp::export(rng=false)]]
+std::string seed_address(SEXP x) {
+    // Used as an identity-based key when memoizing seeds in initializeCpp().
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%p", static_cast<void*>(x));
+    return std::string(buffer);
+}
@@ -0,0 +1,293 @@
+#include "Rtatami.h"
+#include "Rcpp.h"
+
+#include "node_info.h"
+
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <limits>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Layout of a matrix in shared memory.
+ * The header is followed by the column-major values for dense matrices,
+ * or by the column pointers, row indices and values for compressed sparse column matrices.
+ * Each array starts on an 8-byte boundary.
+ */
+struct SharedMatrixHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t sparse;
+    std::uint64_t nrow, ncol, nnz;
+};
+
+static const char shared_magic[8] = { 'B', 'E', 'A', 'C', 'H', 'S', 'H', 'M' };
+
+static std::size_t align8(std::size_t x) {
+    return (x + 7) / 8 * 8;
+}
+
+struct SharedMatrixLayout {
+    SharedMatrixLayout(bool sparse, std::uint64_t nrow, std::uint64_t ncol, std::uint64_t nnz) {
+        std::size_t offset = align8(sizeof(SharedMatrixHeader));
+        if (sparse) {
+            pointers = offset;
+            offset += align8(sizeof(std::uint64_t) * (ncol + 1));
+            indices = offset;
+            offset += align8(sizeof(int) * nnz);
+            values = offset;
+            offset += sizeof(double) * nnz;
+        } else {
+            values = offset;
+            offset += sizeof(double) * nrow * ncol;
+        }
+        total = offset;
+    }
+
+    std::size_t pointers = 0, indices = 0, values = 0, total = 0;
+};
+
+#ifndef _WIN32
+/**
+ * Owns a mapping of a shared memory object, which is unmapped upon destruction.
+ * This is held in the 'original' slot of the BoundNumericMatrix so that the mapping outlives the tatami matrix.
+ */
+class SharedMapping {
+public:
+    SharedMapping(void* address, std::size_t size) : my_address(address), my_size(size) {}
+
+    ~SharedMapping() {
+        munmap(my_address, my_size);
+    }
+
+    SharedMapping(const SharedMapping&) = delete;
+    SharedMapping& operator=(const SharedMapping&) = delete;
+
+    unsigned char* get() const {
+        return static_cast<unsigned char*>(my_address);
+    }
+
+    std::size_t size() const {
+        return my_size;
+    }
+
+private:
+    void* my_address;
+    std::size_t my_size;
+};
+
+static std::string describe_error(const std::string& msg, const std::string& name) {
+    return msg + " '" + name + "' (" + std::strerror(errno) + ")";
+}
+#endif
+
+//[[Rcpp::export(rng=false)]]
+Rcpp::List export_shared_matrix(SEXP raw_input, std::string name, int threads) {
+#ifdef _WIN32
+    throw std::runtime_error("shared memory matrices are not supported on Windows");
+#else
+    if (threads < 1) {
+        throw std::runtime_error("'threads' should be a positive integer");
+    }
+
+    Rtatami::BoundNumericPointer input(raw_input);
+    const auto& shared = input->ptr;
+    const int NR = shared->nrow();
+    const int NC = shared->ncol();
+    const bool sparse = shared->is_sparse();
+
+    // Counting the non-zeros in each column first, so that we know how much space to allocate.
+    std::vector<std::uint64_t> pointers;
+    std::uint64_t nnz = 0;
+    if (sparse) {
+        pointers.resize(static_cast<std::size_t>(NC) + 1);
+        tatami::parallelize([&](int, int start, int length) -> void {
+            tatami::Options opt;
+            opt.sparse_extract_value = false;
+            opt.sparse_extract_index = false;
+            auto ext = tatami::consecutive_extractor<true>(shared.get(), false, start, length, opt);
+            for (int c = start, end = start + length; c < end; ++c) {
+                auto range = ext->fetch(NULL, NULL);
+                pointers[c + 1] = range.number;
+            }
+        }, NC, threads);
+        for (int c = 0; c < NC; ++c) {
+            pointers[c + 1] += pointers[c];
+        }
+        nnz = pointers.back();
+    }
+
+    SharedMatrixLayout layout(sparse, NR, NC, nnz);
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error(describe_error("failed to create shared memory object", name));
+    }
+    if (ftruncate(fd, layout.total) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error(describe_error("failed to resize shared memory object", name));
+    }
+
+#ifdef __linux__
+    // ftruncate() does not reserve any pages on tmpfs, so writing to the mapping would raise SIGBUS if /dev/shm runs out of space.
+    // We reserve the pages up front so that we can raise an error instead.
+    if (layout.total > 0) {
+        int status = posix_fallocate(fd, 0, layout.total);
+        if (status != 0) {
+            close(fd);
+            shm_unlink(name.c_str());
+            if (status == ENOSPC) {
+                throw std::runtime_error("insufficient space to create shared memory object '" + name + "' of " + std::to_string(layout.total) + " bytes");
+            }
+            errno = status;
+            throw std::runtime_error(describe_error("failed to allocate shared memory object", name));
+        }
+    }
+#endif
+    void* address = mmap(NULL, layout.total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw std::runtime_error(describe_error("failed to map shared memory object", name));
+    }
+    SharedMapping mapping(address, layout.total);
+
+    try {
+        auto base = mapping.get();
+        SharedMatrixHeader header;
+        std::memcpy(header.magic, shared_magic, sizeof(shared_magic));
+        header.version = 1;
+        header.sparse = sparse;
+        header.nrow = NR;
+        header.ncol = NC;
+        header.nnz = nnz;
+        std::memcpy(base, &header, sizeof(header));
+
+        // Writing directly into the mapping, to avoid holding a second copy of the matrix in this process.
+        double* vptr = reinterpret_cast<double*>(base + layout.values);
+        if (sparse) {
+            std::copy(pointers.begin(), pointers.end(), reinterpret_cast<std::uint64_t*>(base + layout.pointers));
+            int* iptr = reinterpret_cast<int*>(base + layout.indices);
+            tatami::parallelize([&](int, int start, int length) -> void {
+                auto ext = tatami::consecutive_extractor<true>(shared.get(), false, start, length);
+                for (int c = start, end = start + length; c < end; ++c) {
+                    auto offset = pointers[c];
+                    auto range = ext->fetch(vptr + offset, iptr + offset);
+                    tatami::copy_n(range.value, range.number, vptr + offset);
+                    tatami::copy_n(range.index, range.number, iptr + offset);
+                }
+            }, NC, threads);
+        } else {
+            tatami::convert_to_dense(shared.get(), false, vptr, threads);
+        }
+
+    } catch (...) {
+        shm_unlink(name.c_str());
+        throw;
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("nrow") = NR,
+        Rcpp::Named("ncol") = NC,
+        Rcpp::Named("sparse") = sparse
+    );
+#endif
+}
+
+//[[Rcpp::export(rng=false)]]
+SEXP attach_shared_matrix(std::string name) {
+#ifdef _WIN32
+    throw std::runtime_error("shared memory matrices are not supported on Windows");
+#else
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error(describe_error("failed to open shared memory object", name));
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error(describe_error("failed to query shared memory object", name));
+    }
+    std::size_t size = info.st_size;
+    if (size < sizeof(SharedMatrixHeader)) {
+        close(fd);
+        throw std::runtime_error("shared memory object '" + name + "' is too small to contain a matrix");
+    }
+    void* address = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        throw std::runtime_error(describe_error("failed to map shared memory object", name));
+    }
+    Rcpp::XPtr<SharedMapping> mapping(new SharedMapping(address, size), true);
+
+    SharedMatrixHeader header;
+    auto base = mapping->get();
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, shared_magic, sizeof(shared_magic)) != 0 || header.version != 1 || header.sparse > 1) {
+        throw std::runtime_error("shared memory object '" + name + "' does not contain a matrix created by 'beachmat'");
+    }
+
+    // The segment might have been modified by another process, so we don't trust the header.
+    // Checking the dimensions before computing the layout, to avoid overflow in the size calculations.
+    constexpr std::uint64_t max_dim = std::numeric_limits<int>::max();
+    if (header.nrow > max_dim || header.ncol > max_dim) {
+        throw std::runtime_error("dimensions of the matrix in shared memory object '" + name + "' are too large");
+    }
+    std::uint64_t available = size;
+    if (header.sparse) {
+        if (header.nnz > available / (sizeof(int) + sizeof(double)) || header.nnz > header.nrow * header.ncol) {
+            throw std::runtime_error("number of non-zero elements in shared memory object '" + name + "' is inconsistent with its size");
+        }
+    } else {
+        if (header.nrow * header.ncol > available / sizeof(double)) { // nrow * ncol <= 2^62, so this doesn't overflow.
+            throw std::runtime_error("shared memory object '" + name + "' is truncated");
+        }
+    }
+    SharedMatrixLayout layout(header.sparse, header.nrow, header.ncol, header.nnz);
+    if (layout.total > size) {
+        throw std::runtime_error("shared memory object '" + name + "' is truncated");
+    }
+
+    auto output = Rtatami::new_BoundNumericMatrix();
+    const int NR = header.nrow;
+    const int NC = header.ncol;
+    tatami::ArrayView<double> values(reinterpret_cast<const double*>(base + layout.values), header.sparse ? header.nnz : header.nrow * header.ncol);
+
+    if (header.sparse) {
+        tatami::ArrayView<int> indices(reinterpret_cast<const int*>(base + layout.indices), header.nnz);
+        tatami::ArrayView<std::uint64_t> pointers(reinterpret_cast<const std::uint64_t*>(base + layout.pointers), header.ncol + 1);
+        output->ptr.reset(new tatami::CompressedSparseMatrix<double, int, decltype(values), decltype(indices), decltype(pointers)>(
+            NR, NC, std::move(values), std::move(indices), std::move(pointers), false, /* check = */ true
+        ));
+    } else {
+        output->ptr.reset(new tatami::DenseMatrix<double, int, decltype(values)>(NR, NC, std::move(values), false));
+    }
+
+    output->original = mapping; // holding the mapping to keep it alive.
+    annotate_node(output, "attach_shared_matrix", Rcpp::List(), Rcpp::List::create(Rcpp::Named("name") = name));
+    return output;
+#endif
+}
+
+//[[Rcpp::export(rng=false)]]
+SEXP unlink_shared_matrix(std::string name) {
+#ifdef _WIN32
+    throw std::runtime_error("shared memory matrices are not supported on Windows");
+#else
+    if (shm_unlink(name.c_str()) != 0) {
+        throw std::runtime_error(describe_error("failed to unlink shared memory object", name));
+    }
+    return R_NilValue;
+#endif
+}
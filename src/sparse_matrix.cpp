@@ -5,8 +5,11 @@
 #include <stdexcept>
 #include <vector>
 #include <algorithm>
+#include <cstddef>
 
 #include "na_cast.h"
+#include "node_info.h"
+#include "svt_leaf.h"
 
 template<typename T_, typename XVector_>
 tatami::NumericMatrix* store_sparse_matrix(XVector_ x, Rcpp::IntegerVector i, Rcpp::IntegerVector p, int nrow, int ncol, bool byrow) {
@@ -53,6 +56,7 @@ SEXP initialize_sparse_matrix(Rcpp::RObject raw_x, Rcpp::RObject raw_i, Rcpp::RO
     }
 
     output->original = store; // holding references to all R objects created here, to avoid GC.
+    annotate_node(output, "initialize_sparse_matrix", Rcpp::List(), Rcpp::List::create(Rcpp::Named("raw_x") = raw_x, Rcpp::Named("raw_i") = raw_i, Rcpp::Named("raw_p") = raw_p, Rcpp::Named("nrow") = nrow, Rcpp::Named("ncol") = ncol, Rcpp::Named("byrow") = byrow, Rcpp::Named("check_na") = check_na));
     return output;
 }
 
@@ -60,70 +64,75 @@ SEXP initialize_sparse_matrix(Rcpp::RObject raw_x, Rcpp::RObject raw_i, Rcpp::RO
 SEXP initialize_SVT_SparseMatrix(int nr, int nc, Rcpp::RObject seed, bool check_na) {
     auto output = Rtatami::new_BoundNumericMatrix();
 
+    SvtLeafReader reader(seed, nc);
+    const auto& type = reader.type();
+    bool use_double = (type == "double");
+    int expected_sexptype = reader.sexptype();
+
     std::vector<tatami::ArrayView<int> > indices(nc, tatami::ArrayView<int>(NULL, 0));
     std::vector<tatami::ArrayView<double> > values_d;
     std::vector<tatami::ArrayView<int> > values_i;
-
-    std::string type = Rcpp::as<std::string>(seed.slot("type"));
-    bool use_double = (type == "double");
     if (use_double) {
         values_d.resize(nc, tatami::ArrayView<double>(NULL, 0));
-    } else if (type == "integer" || type == "logical") {
-        values_i.resize(nc, tatami::ArrayView<int>(NULL, 0));
     } else {
-        throw std::runtime_error("unsupported type '" + type + "' for a SVT_SparseMatrix");
+        values_i.resize(nc, tatami::ArrayView<int>(NULL, 0));
     }
 
-    // Setting up buffers of all-1 values so that we can create views on it
-    // whenever we encounter lacunar leaf nodes.
-    Rcpp::IntegerVector alloc_i;
-    Rcpp::NumericVector alloc_d;
-
-    // Storing everything that we take a view on to avoid GC. It may not be
-    // enough to store a reference to the top-level seed, as there might be
-    // some ALTREP magic happening under the hood to realize each vector.
-    Rcpp::List store_i(nc), store_v(nc);
-
-    tatami_r::parse_SVT_SparseMatrix(seed, [&](int c, const Rcpp::IntegerVector& curindices, bool all_ones, const auto& curvalues) {
-        indices[c] = tatami::ArrayView<int>(static_cast<const int*>(curindices.begin()), curindices.size());
-        store_i[c] = curindices;
-
-        if (all_ones) {
-            if (use_double) {
-                if (static_cast<int>(alloc_d.size()) != nr) {
-                    alloc_d = Rcpp::IntegerVector(nr);
-                    std::fill(alloc_d.begin(), alloc_d.end(), 1);
-                }
-                values_d[c] = tatami::ArrayView<double>(static_cast<const double*>(alloc_d.begin()), curindices.size());
-            } else {
-                if (static_cast<int>(alloc_i.size()) != nr) {
-                    alloc_i = Rcpp::IntegerVector(nr);
-                    std::fill(alloc_i.begin(), alloc_i.end(), 1);
-                }
-                values_i[c] = tatami::ArrayView<int>(static_cast<const int*>(alloc_i.begin()), curindices.size());
-            }
-        } else {
-            typedef tatami::ElementType<decltype(curvalues)> StoredValue;
-            constexpr bool is_int = std::is_same<StoredValue, int>::value;
-            if (is_int == use_double) {
-                throw std::runtime_error("unexpected value vector type for a SVT_SparseMatrix of type '" + type + "'");
-            }
+    // Any ALTREP leaf is materialized within the leaf itself when we ask for
+    // its data pointer, so the views remain valid as long as 'svt' is alive.
+    const auto& svt = reader.svt();
+    bool has_na = false;
+    std::vector<int> lacunar;
+    std::size_t max_lacunar = 0;
+
+    for (int c = 0; c < nc; ++c) {
+        auto leaf = reader.get(c);
+        if (leaf.nnz == 0) {
+            continue;
+        }
+        indices[c] = tatami::ArrayView<int>(leaf.indices, leaf.nnz);
 
-            if constexpr(is_int) {
-                values_i[c] = tatami::ArrayView<int>(static_cast<const int*>(curvalues.begin()), curvalues.size());
-            } else {
-                values_d[c] = tatami::ArrayView<double>(static_cast<const double*>(curvalues.begin()), curvalues.size());
+        if (leaf.values == R_NilValue) {
+            lacunar.push_back(c);
+            max_lacunar = std::max(max_lacunar, static_cast<std::size_t>(leaf.nnz));
+            continue;
+        }
+
+        if (use_double) {
+            values_d[c] = tatami::ArrayView<double>(static_cast<const double*>(REAL(leaf.values)), leaf.nnz);
+        } else {
+            const int* vptr = (expected_sexptype == INTSXP ? INTEGER(leaf.values) : LOGICAL(leaf.values));
+            values_i[c] = tatami::ArrayView<int>(vptr, leaf.nnz);
+            if (check_na && !has_na) {
+                has_na = std::find(vptr, vptr + leaf.nnz, NA_INTEGER) != vptr + leaf.nnz;
             }
+        }
+    }
 
-            store_v[c] = curvalues;
+    // All lacunar leaves share a single buffer of ones, allocated once with
+    // enough space for the longest leaf.
+    Rcpp::RObject ones;
+    if (use_double) {
+        Rcpp::NumericVector alloc(max_lacunar, 1.0);
+        for (auto c : lacunar) {
+            values_d[c] = tatami::ArrayView<double>(static_cast<const double*>(alloc.begin()), indices[c].size());
         }
-    });
+        ones = alloc;
+    } else {
+        Rcpp::IntegerVector alloc(max_lacunar, 1);
+        for (auto c : lacunar) {
+            values_i[c] = tatami::ArrayView<int>(static_cast<const int*>(alloc.begin()), indices[c].size());
+        }
+        ones = alloc;
+    }
 
     if (use_double) {
         output->ptr.reset(new tatami::FragmentedSparseMatrix<double, int, decltype(values_d), decltype(indices)>(nr, nc, std::move(values_d), std::move(indices), false, false));
     } else {
         output->ptr.reset(new tatami::FragmentedSparseMatrix<double, int, decltype(values_i), decltype(indices)>(nr, nc, std::move(values_i), std::move(indices), false, false));
-        if (check_na) {
+
+        // Only adding the NA-casting layer if there are actually any NAs to cast.
+        if (has_na) {
             if (type == "integer") {
                 auto masked = delayed_cast_na_integer(std::move(output->ptr)); 
                 output->ptr = std::move(masked);
@@ -134,6 +143,7 @@ SEXP initialize_SVT_SparseMatrix(int nr, int nc, Rcpp::RObject seed, bool check_
         }
     }
 
-    output->original = Rcpp::List::create(store_i, store_v, alloc_i, alloc_d);
+    output->original = Rcpp::List::create(svt, ones);
+    annotate_node(output, "initialize_SVT_SparseMatrix", Rcpp::List(), Rcpp::List::create(Rcpp::Named("nr") = nr, Rcpp::Named("nc") = nc, Rcpp::Named("seed") = seed, Rcpp::Named("check_na") = check_na));
     return output;
 }
@@ -0,0 +1,113 @@
+#ifndef BEACHMAT_SVT_LEAF_H
+#define BEACHMAT_SVT_LEAF_H
+
+#include "Rcpp.h"
+
+#include <string>
+#include <stdexcept>
+
+/**
+ * Decode the leaves of the 'SVT' slot of a SVT_SparseMatrix.
+ * This is shared by all functions that walk over the leaves so that they agree on the layout.
+ *
+ * In version 0 of the SVT layout (i.e., no '.svt_version' slot), each leaf is a `list(nzoffs, nzvals)`.
+ * From version 1 onwards, each leaf is a `list(nzvals, nzoffs)` where `nzvals` may be NULL for a lacunar leaf, i.e., all values are 1.
+ *
+ * We work directly on the SEXPs to avoid the overhead of creating Rcpp objects for each leaf, which is noticeable for matrices with many columns.
+ * It is sufficient to protect the top-level list (held by this object) as it holds references to all leaves.
+ */
+class SvtLeafReader {
+public:
+    SvtLeafReader(const Rcpp::RObject& seed, int nc) : my_type(Rcpp::as<std::string>(seed.slot("type"))), my_svt(seed.slot("SVT")) {
+        if (my_type == "double") {
+            my_sexptype = REALSXP;
+        } else if (my_type == "integer") {
+            my_sexptype = INTSXP;
+        } else if (my_type == "logical") {
+            my_sexptype = LGLSXP;
+        } else {
+            throw std::runtime_error("unsupported type '" + my_type + "' for a SVT_SparseMatrix");
+        }
+
+        int svt_version = 0;
+        if (seed.hasSlot(".svt_version")) {
+            svt_version = Rcpp::as<int>(seed.slot(".svt_version"));
+        }
+        my_index_pos = (svt_version == 0 ? 0 : 1);
+        my_value_pos = (svt_version == 0 ? 1 : 0);
+
+        if (my_svt.sexp_type() == VECSXP) {
+            if (Rf_xlength(my_svt.get__()) != nc) {
+                throw std::runtime_error("'SVT' slot of a SVT_SparseMatrix should have length equal to the number of columns");
+            }
+        }
+    }
+
+public:
+    struct Leaf {
+        const int* indices = NULL;
+        R_xlen_t nnz = 0;
+        SEXP values = R_NilValue; // NULL for lacunar leaves.
+    };
+
+    /**
+     * @param c Column index.
+     * @return Contents of the leaf for column `c`.
+     * Empty columns (including all columns if the 'SVT' slot is NULL) have `nnz = 0`.
+     * Lacunar leaves have `values = R_NilValue` and non-zero `nnz`.
+     */
+    Leaf get(int c) const {
+        Leaf output;
+        if (my_svt.sexp_type() != VECSXP) {
+            return output;
+        }
+
+        SEXP leaf = VECTOR_ELT(my_svt.get__(), c);
+        if (leaf == R_NilValue) {
+            return output;
+        }
+        if (TYPEOF(leaf) != VECSXP || Rf_xlength(leaf) < 2) {
+            throw std::runtime_error("each leaf of a SVT_SparseMatrix should be a list of length 2");
+        }
+
+        SEXP curindices = VECTOR_ELT(leaf, my_index_pos);
+        if (TYPEOF(curindices) != INTSXP) {
+            throw std::runtime_error("indices of a SVT_SparseMatrix leaf should be an integer vector");
+        }
+        output.indices = INTEGER(curindices);
+        output.nnz = Rf_xlength(curindices);
+
+        SEXP curvalues = VECTOR_ELT(leaf, my_value_pos);
+        if (curvalues == R_NilValue) {
+            return output;
+        }
+        if (TYPEOF(curvalues) != my_sexptype) {
+            throw std::runtime_error("unexpected value vector type for a SVT_SparseMatrix of type '" + my_type + "'");
+        }
+        if (Rf_xlength(curvalues) != output.nnz) {
+            throw std::runtime_error("values and indices of a SVT_SparseMatrix leaf should have the same length");
+        }
+        output.values = curvalues;
+        return output;
+    }
+
+    const std::string& type() const {
+        return my_type;
+    }
+
+    int sexptype() const {
+        return my_sexptype;
+    }
+
+    const Rcpp::RObject& svt() const {
+        return my_svt;
+    }
+
+private:
+    std::string my_type;
+    int my_sexptype;
+    Rcpp::RObject my_svt;
+    int my_index_pos, my_value_pos;
+};
+
+#endif
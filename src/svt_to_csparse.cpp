@@ -0,0 +1,118 @@
+#include "Rtatami.h"
+#include "svt_leaf.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Convert the SVT slot of a SVT_SparseMatrix directly into the 'x', 'i' and 'p' slots of a CsparseMatrix.
+ * Double and integer values are returned as doubles (i.e., for a dgCMatrix) while logical values are returned as-is (i.e., for a lgCMatrix).
+ *
+ * The leaves are inspected once on the main thread, as obtaining the data pointers may materialize ALTREP vectors.
+ * The lengths of the leaves are stored in 'p' and cumulated with a parallel prefix sum:
+ * each worker sums its own range of columns, the per-worker totals are cumulated, and each worker then cumulates its range from its offset.
+ * Each column is then filled in parallel into its own stretch of the output vectors.
+ */
+//[[Rcpp::export(rng=false)]]
+Rcpp::List svt_to_csparse(Rcpp::RObject seed, int nc, int threads) {
+    if (threads < 1) {
+        throw std::runtime_error("'threads' should be a positive integer");
+    }
+
+    SvtLeafReader reader(seed, nc);
+    int expected_sexptype = reader.sexptype();
+
+    Rcpp::IntegerVector p(static_cast<std::size_t>(nc) + 1);
+    auto pptr = static_cast<int*>(p.begin());
+    std::vector<const int*> indices(nc);
+    std::vector<const void*> values(nc);
+
+    for (int c = 0; c < nc; ++c) {
+        auto leaf = reader.get(c);
+        if (leaf.nnz == 0) {
+            continue;
+        }
+        pptr[c + 1] = leaf.nnz;
+        indices[c] = leaf.indices;
+        if (leaf.values != R_NilValue) {
+            values[c] = DATAPTR_RO(leaf.values);
+        } // otherwise, a lacunar leaf where all values are 1.
+    }
+
+    std::vector<std::size_t> totals(threads);
+    tatami::parallelize([&](int w, int start, int length) -> void {
+        std::size_t& current = totals[w];
+        for (int c = start, end = start + length; c < end; ++c) {
+            current += pptr[c + 1];
+        }
+    }, nc, threads);
+
+    std::size_t overall = 0;
+    for (auto& t : totals) {
+        auto previous = overall;
+        overall += t;
+        t = previous;
+    }
+    if (overall > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        throw std::runtime_error("number of non-zero elements in a SVT_SparseMatrix is too large for a CsparseMatrix");
+    }
+
+    tatami::parallelize([&](int w, int start, int length) -> void {
+        std::size_t current = totals[w];
+        for (int c = start, end = start + length; c < end; ++c) {
+            current += pptr[c + 1];
+            pptr[c + 1] = current;
+        }
+    }, nc, threads);
+
+    Rcpp::IntegerVector out_i(overall);
+    auto iptr = static_cast<int*>(out_i.begin());
+
+    auto fill = [&](auto* xptr) -> void {
+        tatami::parallelize([&](int, int start, int length) -> void {
+            for (int c = start, end = start + length; c < end; ++c) {
+                std::size_t offset = pptr[c];
+                std::size_t nnz = pptr[c + 1] - offset;
+                if (nnz == 0) {
+                    continue;
+                }
+
+                std::copy_n(indices[c], nnz, iptr + offset);
+                auto out = xptr + offset;
+                if (values[c] == NULL) {
+                    std::fill_n(out, nnz, 1);
+                } else if (expected_sexptype == REALSXP) {
+                    std::copy_n(static_cast<const double*>(values[c]), nnz, out);
+                } else {
+                    auto in = static_cast<const int*>(values[c]);
+                    if constexpr(std::is_same<typename std::remove_pointer<decltype(xptr)>::type, double>::value) {
+                        // Integer NAs need to be converted to double-precision NAs.
+                        for (std::size_t k = 0; k < nnz; ++k) {
+                            out[k] = (in[k] == NA_INTEGER ? NA_REAL : static_cast<double>(in[k]));
+                        }
+                    } else {
+                        std::copy_n(in, nnz, out);
+                    }
+                }
+            }
+        }, nc, threads);
+    };
+
+    Rcpp::RObject out_x;
+    if (expected_sexptype == LGLSXP) {
+        Rcpp::LogicalVector alloc(overall);
+        fill(static_cast<int*>(alloc.begin()));
+        out_x = alloc;
+    } else {
+        Rcpp::NumericVector alloc(overall);
+        fill(static_cast<double*>(alloc.begin()));
+        out_x = alloc;
+    }
+
+    return Rcpp::List::create(Rcpp::Named("x") = out_x, Rcpp::Named("i") = out_i, Rcpp::Named("p") = p);
+}
@@ -1,11 +1,18 @@
 #include "Rtatami.h"
+#include "Rtatami_builder.h"
+#include "Rtatami_partition.h"
 #include "Rcpp.h"
 #include "tatami_stats/tatami_stats.hpp"
 #include "tatami_mult/tatami_mult.hpp"
 
+#include "async_job.h"
+#include "node_info.h"
+#include "rle_matrix.h"
+
 #include <vector>
 #include <cstddef>
 #include <stdexcept>
+#include <string>
 
 //[[Rcpp::export(rng=false)]]
 Rcpp::IntegerVector tatami_dim(SEXP raw_input) {
@@ -47,6 +54,59 @@ Rcpp::NumericVector tatami_get(SEXP raw_input, int i, bool row) {
     return output;
 }
 
+/**
+ * Partition the 'row' dimension of the matrix into contiguous ranges with similar numbers of non-zero elements.
+ * For compressed sparse matrices created by initialize_sparse_matrix(), we use the pointers directly;
+ * otherwise, we fall back to sampling the density of the matrix.
+ */
+static std::vector<int> choose_partitions(const Rtatami::BoundNumericPointer& input, bool row, int threads) {
+    Rcpp::RObject node = input.attr("tatami.node");
+    if (!node.isNULL()) {
+        Rcpp::List info(node);
+        if (Rcpp::as<std::string>(info["type"]) == "initialize_sparse_matrix") {
+            Rcpp::List args(info["args"]);
+            if (Rcpp::as<bool>(args["byrow"]) == row) {
+                Rcpp::IntegerVector p(args["raw_p"]);
+                return Rtatami::partition_by_pointers(static_cast<const int*>(p.begin()), p.size() - 1, threads);
+            }
+        }
+    }
+    return Rtatami::partition_by_density(*(input->ptr), row, threads);
+}
+
+/**
+ * tatami_stats splits the target dimension into equal-length ranges, which is inefficient for sparse matrices with skewed numbers of non-zeros.
+ * If the target dimension is also the preferred dimension, we instead run the single-threaded statistic on a subset of the matrix for each balanced range.
+ * Returns false if balancing was not performed, in which case the caller should just use tatami_stats directly.
+ */
+template<class Function_>
+static bool run_balanced(const Rtatami::BoundNumericPointer& input, bool row, int threads, Function_ fun) {
+    const auto& shared = input->ptr;
+    if (threads <= 1 || !shared->is_sparse() || shared->prefer_rows() != row) {
+        return false;
+    }
+
+    auto partitions = choose_partitions(input, row, threads);
+    Rtatami::parallelize_partitions([&](int, int start, int length) -> void {
+        tatami::DelayedSubsetBlock<double, int> sub(shared, start, length, row);
+        fun(sub, start);
+    }, partitions);
+    return true;
+}
+
+/**
+ * For RLE matrices created by initialize_rle_matrix(), sums can be computed per run rather than per element.
+ * Returns false if the matrix is not an RLE matrix, in which case the caller should compute the sums as usual.
+ */
+static bool run_rle_sums(const Rtatami::BoundNumericPointer& input, bool row, double* output) {
+    auto rle = dynamic_cast<const RleMatrix<double, int>*>(input->ptr.get());
+    if (rle == NULL) {
+        return false;
+    }
+    rle_sums(rle->runs(), row, output);
+    return true;
+}
+
 //[[Rcpp::export(rng=false)]]
 Rcpp::NumericVector tatami_sums(SEXP raw_input, bool row, int threads) {
     tatami_stats::SumOptions opt;
@@ -60,7 +120,19 @@ Rcpp::NumericVector tatami_sums(SEXP raw_input, bool row, int threads) {
     const auto NC = input->ptr->ncol();
 
     Rcpp::NumericVector output(row ? NR : NC);
-    tatami_stats::sum(row, *(input->ptr), static_cast<double*>(output.begin()), opt);
+    auto optr = static_cast<double*>(output.begin());
+    if (run_rle_sums(input, row, optr)) {
+        return output;
+    }
+
+    bool balanced = run_balanced(input, row, threads, [&](const tatami::NumericMatrix& sub, int start) -> void {
+        auto subopt = opt;
+        subopt.num_threads = 1;
+        tatami_stats::sum(row, sub, optr + start, subopt);
+    });
+    if (!balanced) {
+        tatami_stats::sum(row, *(input->ptr), optr, opt);
+    }
     return output;
 }
 
@@ -95,7 +167,18 @@ Rcpp::NumericVector tatami_sums_by_group(SEXP raw_input, Rcpp::IntegerVector gro
     for (auto i = static_cast<decltype(num_groups)>(0); i < num_groups; ++i) {
         ptrs[i] = output.begin() + sanisizer::product_unsafe<std::size_t>(i, stride);
     }
-    tatami_stats::group_sum(row, *(input->ptr), group_m1.data(), num_groups, ptrs, opt);
+    bool balanced = run_balanced(input, row, threads, [&](const tatami::NumericMatrix& sub, int start) -> void {
+        auto subopt = opt;
+        subopt.num_threads = 1;
+        auto subptrs = ptrs;
+        for (auto& ptr : subptrs) {
+            ptr += start;
+        }
+        tatami_stats::group_sum(row, sub, group_m1.data(), num_groups, subptrs, subopt);
+    });
+    if (!balanced) {
+        tatami_stats::group_sum(row, *(input->ptr), group_m1.data(), num_groups, ptrs, opt);
+    }
 
     if (row) {
         return output;
@@ -117,7 +200,15 @@ Rcpp::NumericVector tatami_medians(SEXP raw_input, bool row, int threads) {
     const auto NC = input->ptr->ncol();
 
     Rcpp::NumericVector output(row ? NR : NC);
-    tatami_stats::median(row, *(input->ptr), static_cast<double*>(output.begin()), opt);
+    auto optr = static_cast<double*>(output.begin());
+    bool balanced = run_balanced(input, row, threads, [&](const tatami::NumericMatrix& sub, int start) -> void {
+        auto subopt = opt;
+        subopt.num_threads = 1;
+        tatami_stats::median(row, sub, optr + start, subopt);
+    });
+    if (!balanced) {
+        tatami_stats::median(row, *(input->ptr), optr, opt);
+    }
     return output;
 }
 
@@ -134,62 +225,242 @@ Rcpp::NumericVector tatami_nan_counts(SEXP raw_input, bool row, int threads) {
     const auto NC = input->ptr->ncol();
 
     Rcpp::NumericVector output(row ? NR : NC);
-    tatami_stats::count(
-        row,
-        *(input->ptr),
-        static_cast<double*>(output.begin()),
-        [](const double val) -> bool { return std::isnan(val); },
-        opt
-    );
+    auto optr = static_cast<double*>(output.begin());
+    auto is_nan = [](const double val) -> bool { return std::isnan(val); };
+    bool balanced = run_balanced(input, row, threads, [&](const tatami::NumericMatrix& sub, int start) -> void {
+        auto subopt = opt;
+        subopt.num_threads = 1;
+        tatami_stats::count(row, sub, optr + start, is_nan, subopt);
+    });
+    if (!balanced) {
+        tatami_stats::count(row, *(input->ptr), optr, is_nan, opt);
+    }
     return output;
 }
 
 //[[Rcpp::export(rng=false)]]
-SEXP tatami_realize(SEXP raw_input, int threads) {
+Rcpp::NumericVector tatami_nonzero_counts(SEXP raw_input, bool row, int threads) {
+    tatami_stats::CountOptions opt;
+    opt.num_threads = threads;
     if (threads < 1) {
         throw std::runtime_error("'threads' should be a positive integer");
     }
 
     Rtatami::BoundNumericPointer input(raw_input);
-    const auto& shared = input->ptr;
+    const auto NR = input->ptr->nrow();
+    const auto NC = input->ptr->ncol();
 
-    if (shared->sparse()) {
-        auto frag = tatami::retrieve_fragmented_sparse_contents<double, int>(shared.get(), false, threads);
-        const auto& store_v = frag.value;
-        const auto& store_i = frag.index;
-
-        auto primary = shared->ncol();
-        Rcpp::IntegerVector output_p(sanisizer::sum<decltype(std::declval<Rcpp::IntegerVector>().size())>(primary, 1));
-        for (decltype(primary) p = 0; p < primary; ++p) {
-            output_p[p + 1] = output_p[p] + store_v[p].size();
+    Rcpp::NumericVector output(row ? NR : NC);
+    auto optr = static_cast<double*>(output.begin());
+    auto is_nonzero = [](const double val) -> bool { return val != 0; };
+    bool balanced = run_balanced(input, row, threads, [&](const tatami::NumericMatrix& sub, int start) -> void {
+        auto subopt = opt;
+        subopt.num_threads = 1;
+        tatami_stats::count(row, sub, optr + start, is_nonzero, subopt);
+    });
+    if (!balanced) {
+        tatami_stats::count(row, *(input->ptr), optr, is_nonzero, opt);
+    }
+    return output;
+}
+
+/**
+ * Find all entries of the matrix that satisfy a predicate, reported in column-major order.
+ * The first pass counts the number of entries in each column so that the output vectors are only allocated once;
+ * the second pass fills them in parallel, where each column is written to its own stretch of the output.
+ * We only need to inspect the structural non-zeros of sparse matrices if the predicate is false for zero.
+ */
+template<class Predicate_>
+static Rcpp::List which_predicate(const tatami::NumericMatrix& mat, Predicate_ pred, int threads) {
+    const int NR = mat.nrow();
+    const int NC = mat.ncol();
+    const bool use_sparse = mat.is_sparse() && !pred(0);
+
+    // Calls 'fun(r, val)' for each entry in each column that satisfies the predicate.
+    auto visit = [&](int start, int length, auto fun) -> void {
+        std::vector<double> vbuffer(NR);
+        if (use_sparse) {
+            std::vector<int> ibuffer(NR);
+            auto ext = tatami::consecutive_extractor<true>(&mat, false, start, length);
+            for (int c = start, end = start + length; c < end; ++c) {
+                auto range = ext->fetch(vbuffer.data(), ibuffer.data());
+                for (int k = 0; k < range.number; ++k) {
+                    if (pred(range.value[k])) {
+                        fun(c, range.index[k], range.value[k]);
+                    }
+                }
+            }
+        } else {
+            auto ext = tatami::consecutive_extractor<false>(&mat, false, start, length);
+            for (int c = start, end = start + length; c < end; ++c) {
+                auto ptr = ext->fetch(vbuffer.data());
+                for (int r = 0; r < NR; ++r) {
+                    if (pred(ptr[r])) {
+                        fun(c, r, ptr[r]);
+                    }
+                }
+            }
         }
+    };
+
+    std::vector<std::size_t> offsets(static_cast<std::size_t>(NC) + 1);
+    tatami::parallelize([&](int, int start, int length) -> void {
+        visit(start, length, [&](int c, int, double) -> void {
+            ++offsets[c + 1];
+        });
+    }, NC, threads);
+    for (int c = 0; c < NC; ++c) {
+        offsets[c + 1] += offsets[c];
+    }
+
+    const std::size_t total = offsets.back();
+    Rcpp::IntegerVector out_i(total), out_j(total);
+    Rcpp::NumericVector out_x(total);
+    auto iptr = static_cast<int*>(out_i.begin());
+    auto jptr = static_cast<int*>(out_j.begin());
+    auto xptr = static_cast<double*>(out_x.begin());
+
+    tatami::parallelize([&](int, int start, int length) -> void {
+        std::size_t pos = offsets[start]; // entries are visited in column-major order, so we can just keep incrementing.
+        visit(start, length, [&](int c, int r, double val) -> void {
+            iptr[pos] = r + 1;
+            jptr[pos] = c + 1;
+            xptr[pos] = val;
+            ++pos;
+        });
+    }, NC, threads);
+
+    return Rcpp::List::create(Rcpp::Named("i") = out_i, Rcpp::Named("j") = out_j, Rcpp::Named("x") = out_x);
+}
+
+//[[Rcpp::export(rng=false)]]
+Rcpp::List tatami_which(SEXP raw_input, std::string op, double threshold, int threads) {
+    if (threads < 1) {
+        throw std::runtime_error("'threads' should be a positive integer");
+    }
+
+    Rtatami::BoundNumericPointer input(raw_input);
+    const auto& mat = *(input->ptr);
+    if (op == "!=") {
+        return which_predicate(mat, [&](double x) -> bool { return x != threshold; }, threads);
+    } else if (op == "==") {
+        return which_predicate(mat, [&](double x) -> bool { return x == threshold; }, threads);
+    } else if (op == ">") {
+        return which_predicate(mat, [&](double x) -> bool { return x > threshold; }, threads);
+    } else if (op == ">=") {
+        return which_predicate(mat, [&](double x) -> bool { return x >= threshold; }, threads);
+    } else if (op == "<") {
+        return which_predicate(mat, [&](double x) -> bool { return x < threshold; }, threads);
+    } else if (op == "<=") {
+        return which_predicate(mat, [&](double x) -> bool { return x <= threshold; }, threads);
+    } else {
+        throw std::runtime_error("unknown comparison '" + op + "'");
+    }
+}
+
+/**
+ * Run the task directly, or launch it as an asynchronous job.
+ * Jobs involving matrices that call into R via the process-wide executor are deferred until the main thread waits on them, see AsyncJob for details.
+ */
+static SEXP run_or_launch(TatamiTask task, bool async, SEXP raw_input, SEXP more_input = R_NilValue) {
+    if (!async) {
+        return run_task(task);
+    }
+    bool deferred = has_unserviceable_node(raw_input) || (more_input != R_NilValue && has_unserviceable_node(more_input));
+    return Rcpp::XPtr<AsyncJob>(new AsyncJob(std::move(task), deferred), true);
+}
+
+//[[Rcpp::export(rng=false)]]
+SEXP tatami_realize(SEXP raw_input, int threads, bool async) {
+    if (threads < 1) {
+        throw std::runtime_error("'threads' should be a positive integer");
+    }
 
-        auto last_p = output_p[primary];
-        auto output_v = sanisizer::create<Rcpp::NumericVector>(last_p);
-        auto output_i = sanisizer::create<Rcpp::IntegerVector>(last_p);
-        decltype(last_p) offset = 0;
-        for (decltype(primary) p = 0; p < primary; ++p) {
-            std::copy(store_v[p].begin(), store_v[p].end(), output_v.begin() + offset);
-            std::copy(store_i[p].begin(), store_i[p].end(), output_i.begin() + offset);
-            offset += store_v[p].size();
+    Rtatami::BoundNumericPointer input(raw_input);
+    std::shared_ptr<const tatami::NumericMatrix> shared = input->ptr;
+    TatamiTask task;
+
+    if (shared->sparse()) {
+        // Columns are assigned to threads so that each thread gets a similar number of non-zero elements.
+        const auto NR = shared->nrow();
+        const auto NC = shared->ncol();
+        auto partitions = choose_partitions(input, false, threads);
+
+        // If we don't need to call into R, counting the structural non-zeros in a first pass is cheap.
+        // Each thread can then write its columns directly into the dgCMatrix slots, so the peak memory usage is one copy of the output.
+        // This is not done for asynchronous jobs as the slots must be allocated on the main thread between the two passes,
+        // nor for R-backed matrices where each extraction is expensive enough that we don't want to do it twice.
+        if (!async && !has_unknown_node(raw_input)) {
+            Rtatami::TwoPassSparseBuilder builder(NR, NC, false);
+
+            Rtatami::parallelize_partitions([&](int, int start, int length) -> void {
+                tatami::Options opt;
+                opt.sparse_extract_value = false;
+                opt.sparse_extract_index = false;
+                auto ext = tatami::consecutive_extractor<true>(shared.get(), false, start, length, opt);
+                for (int c = start, end = start + length; c < end; ++c) {
+                    auto range = ext->fetch(NULL, NULL);
+                    builder.set_count(c, range.number);
+                }
+            }, partitions);
+
+            builder.allocate();
+
+            Rtatami::parallelize_partitions([&](int, int start, int length) -> void {
+                auto ext = tatami::consecutive_extractor<true>(shared.get(), false, start, length);
+                std::vector<double> vbuffer(NR);
+                std::vector<int> ibuffer(NR);
+                for (int c = start, end = start + length; c < end; ++c) {
+                    auto range = ext->fetch(vbuffer.data(), ibuffer.data());
+                    builder.fill(c, range.number, range.value, range.index);
+                }
+            }, partitions);
+
+            return builder.to_R();
         }
 
-        Rcpp::S4 output("dgCMatrix");
-        output.slot("x") = output_v;
-        output.slot("i") = output_i;
-        output.slot("p") = output_p;
-        output.slot("Dim") = Rcpp::IntegerVector::create(shared->nrow(), shared->ncol());
-        return output;
+        // Otherwise, each thread fills its own columns, which are then copied straight into the dgCMatrix slots.
+        auto builder = std::make_shared<Rtatami::SparseBuilder>(NR, NC, false);
+
+        task.compute = [shared, builder, partitions, NR](const std::atomic<bool>& cancelled) -> void {
+            Rtatami::parallelize_partitions([&](int, int start, int length) -> void {
+                auto work = builder->workspace(start, length);
+                auto ext = tatami::consecutive_extractor<true>(shared.get(), false, start, length);
+                std::vector<double> vbuffer(NR);
+                std::vector<int> ibuffer(NR);
+                for (int c = start, end = start + length; c < end; ++c) {
+                    if (cancelled.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    auto range = ext->fetch(vbuffer.data(), ibuffer.data());
+                    work.add(c, range.number, range.value, range.index);
+                }
+                builder->commit(std::move(work));
+            }, partitions);
+        };
+
+        task.finalize = [builder, threads, input]() -> Rcpp::RObject { // holding 'input' to avoid GC of its R-owned data.
+            return builder->to_R(threads);
+        };
 
     } else {
         Rcpp::NumericMatrix output(shared->nrow(), shared->ncol());
-        tatami::convert_to_dense(shared.get(), false, static_cast<double*>(output.begin()), threads);
-        return output;
+        double* optr = static_cast<double*>(output.begin());
+
+        task.compute = [shared, optr, threads](const std::atomic<bool>&) -> void {
+            tatami::convert_to_dense(shared.get(), false, optr, threads);
+        };
+
+        task.finalize = [output, input]() -> Rcpp::RObject {
+            return output;
+        };
     }
+
+    return run_or_launch(std::move(task), async, raw_input);
 }
 
 //[[Rcpp::export(rng=false)]]
-Rcpp::NumericVector tatami_multiply_vector(SEXP raw_input, Rcpp::NumericVector other, bool right, int threads) {
+SEXP tatami_multiply_vector(SEXP raw_input, Rcpp::NumericVector other, bool right, int threads, bool async) {
     if (threads < 1) {
         throw std::runtime_error("'threads' should be a positive integer");
     }
@@ -197,86 +468,101 @@ Rcpp::NumericVector tatami_multiply_vector(SEXP raw_input, Rcpp::NumericVector o
     tatami_mult::set_num_threads(opt, threads); 
 
     Rtatami::BoundNumericPointer input(raw_input);
-    const auto& shared = input->ptr;
+    std::shared_ptr<const tatami::NumericMatrix> shared = input->ptr;
 
     if (right) {
         if (!sanisizer::is_equal(other.size(), shared->ncol())) {
             throw std::runtime_error("length of vector does not match the number of columns of 'x'");
         }
-        Rcpp::NumericVector output(shared->nrow());
-        tatami_mult::multiply_with_single_vector(*shared, static_cast<const double*>(other.begin()), static_cast<double*>(output.begin()), opt);
-        return output;
-
     } else {
         if (!sanisizer::is_equal(other.size(), shared->nrow())) {
             throw std::runtime_error("length of vector does not match the number of rows of 'x'");
         }
-        Rcpp::NumericVector output(shared->ncol());
-        tatami_mult::multiply_with_single_vector(static_cast<const double*>(other.begin()), *shared, static_cast<double*>(output.begin()), opt);
-        return output;
     }
+
+    Rcpp::NumericVector output(right ? shared->nrow() : shared->ncol());
+    const double* vptr = static_cast<const double*>(other.begin());
+    double* optr = static_cast<double*>(output.begin());
+
+    TatamiTask task;
+    task.compute = [shared, vptr, optr, right, opt](const std::atomic<bool>&) -> void {
+        if (right) {
+            tatami_mult::multiply_with_single_vector(*shared, vptr, optr, opt);
+        } else {
+            tatami_mult::multiply_with_single_vector(vptr, *shared, optr, opt);
+        }
+    };
+    task.finalize = [output, other, input]() -> Rcpp::RObject { // holding the inputs to avoid GC during the computation.
+        return output;
+    };
+
+    return run_or_launch(std::move(task), async, raw_input);
 }
 
 //[[Rcpp::export(rng=false)]]
-Rcpp::NumericVector tatami_multiply_columns(SEXP raw_input, Rcpp::NumericMatrix other, bool right, int threads) {
+SEXP tatami_multiply_columns(SEXP raw_input, Rcpp::NumericMatrix other, bool right, int threads, bool async) {
     if (threads < 1) {
         throw std::runtime_error("'threads' should be a positive integer");
     }
 
     Rtatami::BoundNumericPointer input(raw_input);
-    std::shared_ptr<tatami::NumericMatrix> alt;
-    const auto& mat = [&]() -> const tatami::NumericMatrix& {
-        if (right) {
-            return *(input->ptr);
-        } else {
-            alt.reset(new tatami::DelayedTranspose<double, int>(input->ptr));
-            return *alt;
-        }
-    }();
+    std::shared_ptr<const tatami::NumericMatrix> mat;
+    if (right) {
+        mat = input->ptr;
+    } else {
+        mat.reset(new tatami::DelayedTranspose<double, int>(input->ptr));
+    }
 
     auto common_dim = other.rows();
-    if (!sanisizer::is_equal(common_dim, mat.ncol())) {
+    if (!sanisizer::is_equal(common_dim, mat->ncol())) {
         throw std::runtime_error("rows of 'vals' does not match the number of columns of 'x'");
     }
 
     auto num_other = other.cols();
-    auto out_nrow = mat.nrow();
+    auto out_nrow = mat->nrow();
     sanisizer::product<std::size_t>(out_nrow, num_other); // check outside the loop so that we can do unsafe products inside the loop.
     Rcpp::NumericMatrix output(sanisizer::cast<decltype(num_other)>(out_nrow), num_other);
 
     const auto rptr = static_cast<const double*>(other.begin());
-    auto fetch_other_col = [&](std::size_t rcol) -> const double* { return rptr + sanisizer::product_unsafe<std::size_t>(rcol, common_dim); };
     const auto optr = static_cast<double*>(output.begin()); 
 
-    const bool is_sparse = mat.is_sparse(); 
-    if (mat.prefer_rows()) {
-        if (is_sparse){
-            tatami_mult::MultiplySparseRowWithDenseColumnMatrixToColumnOutputOptions opt;
-            opt.num_threads = threads;
-            tatami_mult::multiply_sparse_row_with_dense_column_matrix_to_column_output(mat, num_other, fetch_other_col, optr, opt);
-        } else {
-            tatami_mult::MultiplyDenseRowWithDenseColumnMatrixToColumnOutputOptions opt;
-            opt.num_threads = threads;
-            tatami_mult::multiply_dense_row_with_dense_column_matrix_to_column_output(mat, num_other, fetch_other_col, optr, opt);
-        }
+    TatamiTask task;
+    task.compute = [mat, rptr, optr, common_dim, num_other, threads](const std::atomic<bool>&) -> void {
+        auto fetch_other_col = [&](std::size_t rcol) -> const double* { return rptr + sanisizer::product_unsafe<std::size_t>(rcol, common_dim); };
+
+        const bool is_sparse = mat->is_sparse(); 
+        if (mat->prefer_rows()) {
+            if (is_sparse){
+                tatami_mult::MultiplySparseRowWithDenseColumnMatrixToColumnOutputOptions opt;
+                opt.num_threads = threads;
+                tatami_mult::multiply_sparse_row_with_dense_column_matrix_to_column_output(*mat, num_other, fetch_other_col, optr, opt);
+            } else {
+                tatami_mult::MultiplyDenseRowWithDenseColumnMatrixToColumnOutputOptions opt;
+                opt.num_threads = threads;
+                tatami_mult::multiply_dense_row_with_dense_column_matrix_to_column_output(*mat, num_other, fetch_other_col, optr, opt);
+            }
 
-    } else {
-        if (is_sparse){
-            tatami_mult::MultiplySparseColumnWithDenseColumnMatrixToColumnOutputOptions opt;
-            opt.num_threads = threads;
-            tatami_mult::multiply_sparse_column_with_dense_column_matrix_to_column_output(mat, num_other, fetch_other_col, optr, opt);
         } else {
-            tatami_mult::MultiplyDenseColumnWithDenseColumnMatrixToColumnOutputOptions opt;
-            opt.num_threads = threads;
-            tatami_mult::multiply_dense_column_with_dense_column_matrix_to_column_output(mat, num_other, fetch_other_col, optr, opt);
+            if (is_sparse){
+                tatami_mult::MultiplySparseColumnWithDenseColumnMatrixToColumnOutputOptions opt;
+                opt.num_threads = threads;
+                tatami_mult::multiply_sparse_column_with_dense_column_matrix_to_column_output(*mat, num_other, fetch_other_col, optr, opt);
+            } else {
+                tatami_mult::MultiplyDenseColumnWithDenseColumnMatrixToColumnOutputOptions opt;
+                opt.num_threads = threads;
+                tatami_mult::multiply_dense_column_with_dense_column_matrix_to_column_output(*mat, num_other, fetch_other_col, optr, opt);
+            }
         }
-    }
+    };
+    task.finalize = [output, other, input]() -> Rcpp::RObject { // holding the inputs to avoid GC during the computation.
+        return output;
+    };
 
-    return output;
+    return run_or_launch(std::move(task), async, raw_input);
 }
 
 //[[Rcpp::export(rng=false)]]
-Rcpp::NumericVector tatami_multiply_matrix(SEXP raw_input, SEXP more_input, bool right, int threads) {
+SEXP tatami_multiply_matrix(SEXP raw_input, SEXP more_input, bool right, int threads, bool async) {
     if (threads < 1) {
         throw std::runtime_error("'threads' should be a positive integer");
     }
@@ -285,14 +571,22 @@ Rcpp::NumericVector tatami_multiply_matrix(SEXP raw_input, SEXP more_input, bool
 
     Rtatami::BoundNumericPointer input(raw_input);
     Rtatami::BoundNumericPointer input2(more_input);
-    const auto& mat = (right ? input->ptr : input2->ptr);
-    const auto& mat2 = (right ? input2->ptr : input->ptr);
+    std::shared_ptr<const tatami::NumericMatrix> mat = (right ? input->ptr : input2->ptr);
+    std::shared_ptr<const tatami::NumericMatrix> mat2 = (right ? input2->ptr : input->ptr);
     if (mat->ncol() != mat2->nrow()) {
         throw std::runtime_error("inconsistent common dimensions for matrix multiplication");
     }
 
     Rcpp::NumericMatrix output(mat->nrow(), mat2->ncol());
-    tatami_mult::multiply_with_matrix(*mat, *mat2, static_cast<double*>(output.begin()), false, opt);
+    double* optr = static_cast<double*>(output.begin());
 
-    return output;
+    TatamiTask task;
+    task.compute = [mat, mat2, optr, opt](const std::atomic<bool>&) -> void {
+        tatami_mult::multiply_with_matrix(*mat, *mat2, optr, false, opt);
+    };
+    task.finalize = [output, input, input2]() -> Rcpp::RObject { // holding the inputs to avoid GC of their R-owned data.
+        return output;
+    };
+
+    return run_or_launch(std::move(task), async, raw_input, more_input);
 }
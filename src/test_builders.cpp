@@ -0,0 +1,103 @@
+#include "Rtatami.h"
+#include "Rtatami_builder.h"
+
+#include <vector>
+#include <stdexcept>
+
+/**
+ * Copy a matrix with the public builder API, for testing the builders in Rtatami_builder.h.
+ * Each thread extracts its own range of rows or columns and writes them into the builder.
+ */
+//[[Rcpp::export(rng=false)]]
+SEXP test_sparse_builder(SEXP raw_input, bool row, bool two_pass, bool bound, int threads) {
+    Rtatami::BoundNumericPointer input(raw_input);
+    const auto& mat = input->ptr;
+    const int NR = mat->nrow(), NC = mat->ncol();
+    const int primary = (row ? NR : NC), secondary = (row ? NC : NR);
+
+    if (!two_pass) {
+        Rtatami::SparseBuilder builder(NR, NC, row);
+        tatami::parallelize([&](int, int start, int length) -> void {
+            auto work = builder.workspace(start, length);
+            auto ext = tatami::consecutive_extractor<true>(mat.get(), row, start, length);
+            std::vector<double> vbuffer(secondary);
+            std::vector<int> ibuffer(secondary);
+            for (int p = start, end = start + length; p < end; ++p) {
+                auto range = ext->fetch(vbuffer.data(), ibuffer.data());
+                work.add(p, range.number, range.value, range.index);
+            }
+            builder.commit(std::move(work));
+        }, primary, threads);
+
+        if (bound) {
+            return builder.to_bound(threads);
+        } else {
+            return builder.to_R(threads);
+        }
+    }
+
+    Rtatami::TwoPassSparseBuilder builder(NR, NC, row);
+    tatami::parallelize([&](int, int start, int length) -> void {
+        tatami::Options opt;
+        opt.sparse_extract_value = false;
+        opt.sparse_extract_index = false;
+        auto ext = tatami::consecutive_extractor<true>(mat.get(), row, start, length, opt);
+        for (int p = start, end = start + length; p < end; ++p) {
+            builder.set_count(p, ext->fetch(NULL, NULL).number);
+        }
+    }, primary, threads);
+
+    builder.allocate();
+
+    tatami::parallelize([&](int, int start, int length) -> void {
+        auto ext = tatami::consecutive_extractor<true>(mat.get(), row, start, length);
+        std::vector<double> vbuffer(secondary);
+        std::vector<int> ibuffer(secondary);
+        for (int p = start, end = start + length; p < end; ++p) {
+            // Alternating between fill() and direct writes to exercise both interfaces.
+            auto range = ext->fetch(vbuffer.data(), ibuffer.data());
+            if (p % 2 == 0) {
+                builder.fill(p, range.number, range.value, range.index);
+            } else {
+                std::copy_n(range.value, range.number, builder.values(p));
+                std::copy_n(range.index, range.number, builder.indices(p));
+            }
+        }
+    }, primary, threads);
+
+    if (bound) {
+        return builder.to_bound();
+    } else {
+        return builder.to_R();
+    }
+}
+
+//[[Rcpp::export(rng=false)]]
+SEXP test_dense_builder(SEXP raw_input, bool row, bool bound, int threads) {
+    Rtatami::BoundNumericPointer input(raw_input);
+    const auto& mat = input->ptr;
+    const int NR = mat->nrow(), NC = mat->ncol();
+
+    Rtatami::DenseBuilder builder(NR, NC);
+    tatami::parallelize([&](int, int start, int length) -> void {
+        if (row) {
+            auto ext = tatami::consecutive_extractor<false>(mat.get(), true, start, length);
+            std::vector<double> buffer(NC);
+            for (int r = start, end = start + length; r < end; ++r) {
+                builder.set_row(r, ext->fetch(buffer.data()));
+            }
+        } else {
+            auto ext = tatami::consecutive_extractor<false>(mat.get(), false, start, length);
+            for (int c = start, end = start + length; c < end; ++c) {
+                auto out = builder.column(c);
+                tatami::copy_n(ext->fetch(out), NR, out);
+            }
+        }
+    }, (row ? NR : NC), threads);
+
+    if (bound) {
+        return builder.to_bound();
+    } else {
+        return builder.to_R();
+    }
+}
@@ -0,0 +1,28 @@
+#include "Rtatami.h"
+
+//[[Rcpp::export(rng=false)]]
+Rcpp::List set_thread_pool(Rcpp::Nullable<Rcpp::IntegerVector> size, Rcpp::Nullable<Rcpp::IntegerVector> spin) {
+    auto& pool = Rtatami::thread_pool();
+    auto output = Rcpp::List::create(
+        Rcpp::Named("size") = pool.size(),
+        Rcpp::Named("spin") = pool.spin()
+    );
+
+    if (size.isNotNull()) {
+        Rcpp::IntegerVector val(size.get());
+        if (val.size() != 1 || val[0] == NA_INTEGER || val[0] < 0) {
+            throw std::runtime_error("'size' should be a non-negative integer scalar");
+        }
+        pool.resize(val[0]);
+    }
+
+    if (spin.isNotNull()) {
+        Rcpp::IntegerVector val(spin.get());
+        if (val.size() != 1 || val[0] == NA_INTEGER || val[0] < 0) {
+            throw std::runtime_error("'spin' should be a non-negative integer scalar");
+        }
+        pool.set_spin(val[0]);
+    }
+
+    return output;
+}
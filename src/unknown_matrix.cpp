@@ -2,10 +2,50 @@
 #include "Rcpp.h"
 #include "tatami_r/tatami_r.hpp"
 
+#include "executor_profile.h"
+#include "coalesced_matrix.h"
+#include "node_info.h"
+
+#include <algorithm>
+#include <thread>
+
+static std::shared_ptr<CoalescedCache> create_coalesced_cache(const Rcpp::RObject& input, const Rcpp::Function& extractor, bool row, int nrow, int ncol, double block_size, std::size_t max_chunks) {
+    int primary = (row ? nrow : ncol);
+    int secondary = (row ? ncol : nrow);
+
+    // Each chunk gets an equal share of the block size, so that the entire cache fits within a single block.
+    double per_chunk = block_size / max_chunks / (sizeof(double) * std::max(secondary, 1));
+    int chunk_size = std::max(1, static_cast<int>(std::min(per_chunk, static_cast<double>(primary))));
+
+    return std::make_shared<CoalescedCache>(input, extractor, row, primary, secondary, chunk_size, max_chunks);
+}
+
 //[[Rcpp::export(rng=false)]]
 SEXP initialize_unknown_matrix(Rcpp::RObject input) {
     auto output = Rtatami::new_BoundNumericMatrix();
     output->original = input;
     output->ptr.reset(new tatami_r::UnknownMatrix<double, int>(input));
+
+    if (executor_coalescing() && !output->ptr->is_sparse()) {
+        Rcpp::Environment delayedarray = Rcpp::Environment::namespace_env("DelayedArray");
+        Rcpp::Function extractor = delayedarray["extract_array"];
+        Rcpp::Function get_block_size = delayedarray["getAutoBlockSize"];
+        double block_size = Rcpp::as<double>(get_block_size());
+        std::size_t max_chunks = std::max(4u, 2 * std::thread::hardware_concurrency());
+
+        int NR = output->ptr->nrow(), NC = output->ptr->ncol();
+        auto coalesced = std::make_shared<CoalescedMatrix<double, int> >(
+            std::move(output->ptr),
+            create_coalesced_cache(input, extractor, true, NR, NC, block_size, max_chunks),
+            create_coalesced_cache(input, extractor, false, NR, NC, block_size, max_chunks)
+        );
+        output->ptr = std::move(coalesced);
+    }
+
+    if (executor_profile().enabled()) {
+        auto profiled = std::make_shared<ProfiledMatrix<double, int> >(std::move(output->ptr));
+        output->ptr = std::move(profiled);
+    }
+    annotate_node(output, "initialize_unknown_matrix", Rcpp::List(), Rcpp::List::create(Rcpp::Named("input") = input));
     return output;
 }